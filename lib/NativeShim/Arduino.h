@@ -0,0 +1,55 @@
+/*
+ * Minimal Arduino replacement for the native (host) build.
+ *
+ * Only covers what the effects use. Time is simulated: millis() only moves
+ * when the host program calls nativeSetMillis() or nativeAdvanceMillis(),
+ * so benchmarks and simulations are deterministic and run as fast as possible.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// Like the ESP8266 core
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define PROGMEM
+#define F(s) (s)
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(const void *const *)(addr))
+#define strcpy_P(dest, src) strcpy((dest), (src))
+#define memcpy_P(dest, src, n) memcpy((dest), (src), (n))
+
+// Simulated time base
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+void nativeSetMillis(unsigned long ms);
+void nativeAdvanceMillis(unsigned long ms);
+
+// Arduino style random numbers
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
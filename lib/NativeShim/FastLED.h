@@ -0,0 +1,301 @@
+/*
+ * Minimal FastLED replacement for the native (host) build.
+ *
+ * Implements the color types, math helpers and palettes the effects use.
+ * The algorithms follow FastLED closely enough for benchmarking and frame
+ * comparison, they are not meant to be bit exact.
+ * FastLED.show() only counts frames.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+// ---------- 8/16 bit math ----------
+
+inline uint8_t scale8(uint8_t i, uint8_t scale)
+{
+  return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8;
+}
+
+inline uint8_t scale8_video(uint8_t i, uint8_t scale)
+{
+  return (((uint16_t)i * (uint16_t)scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+inline uint8_t qadd8(uint8_t i, uint8_t j)
+{
+  uint16_t t = i + j;
+  return (t > 255) ? 255 : t;
+}
+
+inline uint8_t qsub8(uint8_t i, uint8_t j)
+{
+  return (i > j) ? i - j : 0;
+}
+
+inline void memset8(void *ptr, uint8_t value, uint16_t num)
+{
+  memset(ptr, value, num);
+}
+
+inline void memcpy8(void *dst, const void *src, uint16_t num)
+{
+  memcpy(dst, src, num);
+}
+
+int16_t sin16(uint16_t theta);
+int16_t cos16(uint16_t theta);
+
+uint8_t random8();
+uint8_t random8(uint8_t lim);
+uint8_t random8(uint8_t min, uint8_t lim);
+uint16_t random16();
+uint16_t random16(uint16_t lim);
+void random16_set_seed(uint16_t seed);
+
+// ---------- Colors ----------
+
+struct CHSV
+{
+  union
+  {
+    struct
+    {
+      uint8_t h;
+      uint8_t s;
+      uint8_t v;
+    };
+    struct
+    {
+      uint8_t hue;
+      uint8_t sat;
+      uint8_t val;
+    };
+    uint8_t raw[3];
+  };
+
+  CHSV() : h(0), s(0), v(0) {}
+  CHSV(uint8_t ih, uint8_t is, uint8_t iv) : h(ih), s(is), v(iv) {}
+};
+
+struct CRGB;
+void hsv2rgb_rainbow(const CHSV &hsv, CRGB &rgb);
+
+struct CRGB
+{
+  union
+  {
+    struct
+    {
+      uint8_t r;
+      uint8_t g;
+      uint8_t b;
+    };
+    struct
+    {
+      uint8_t red;
+      uint8_t green;
+      uint8_t blue;
+    };
+    uint8_t raw[3];
+  };
+
+  typedef enum
+  {
+    Aqua = 0x00FFFF,
+    Aquamarine = 0x7FFFD4,
+    Black = 0x000000,
+    Blue = 0x0000FF,
+    CadetBlue = 0x5F9EA0,
+    CornflowerBlue = 0x6495ED,
+    DarkBlue = 0x00008B,
+    DarkCyan = 0x008B8B,
+    DarkGreen = 0x006400,
+    DarkOliveGreen = 0x556B2F,
+    DarkRed = 0x8B0000,
+    ForestGreen = 0x228B22,
+    Green = 0x008000,
+    LawnGreen = 0x7CFC00,
+    LightBlue = 0xADD8E6,
+    LightGreen = 0x90EE90,
+    LightSkyBlue = 0x87CEFA,
+    LimeGreen = 0x32CD32,
+    Maroon = 0x800000,
+    MediumAquamarine = 0x66CDAA,
+    MediumBlue = 0x0000CD,
+    MidnightBlue = 0x191970,
+    Navy = 0x000080,
+    OliveDrab = 0x6B8E23,
+    Orange = 0xFFA500,
+    Red = 0xFF0000,
+    SeaGreen = 0x2E8B57,
+    SkyBlue = 0x87CEEB,
+    Teal = 0x008080,
+    White = 0xFFFFFF,
+    YellowGreen = 0x9ACD32
+  } HTMLColorCode;
+
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+  CRGB(HTMLColorCode colorcode) : CRGB((uint32_t)colorcode) {}
+  CRGB(const CHSV &hsv) { hsv2rgb_rainbow(hsv, *this); }
+
+  uint8_t &operator[](uint8_t x) { return raw[x]; }
+  const uint8_t &operator[](uint8_t x) const { return raw[x]; }
+
+  CRGB &operator+=(const CRGB &rhs)
+  {
+    r = qadd8(r, rhs.r);
+    g = qadd8(g, rhs.g);
+    b = qadd8(b, rhs.b);
+    return *this;
+  }
+
+  CRGB &operator-=(const CRGB &rhs)
+  {
+    r = qsub8(r, rhs.r);
+    g = qsub8(g, rhs.g);
+    b = qsub8(b, rhs.b);
+    return *this;
+  }
+
+  CRGB &nscale8(uint8_t scaledown)
+  {
+    r = scale8(r, scaledown);
+    g = scale8(g, scaledown);
+    b = scale8(b, scaledown);
+    return *this;
+  }
+
+  CRGB &nscale8_video(uint8_t scaledown)
+  {
+    r = scale8_video(r, scaledown);
+    g = scale8_video(g, scaledown);
+    b = scale8_video(b, scaledown);
+    return *this;
+  }
+
+  CRGB &fadeToBlackBy(uint8_t fadefactor) { return nscale8(255 - fadefactor); }
+
+  explicit operator bool() const { return r || g || b; }
+};
+
+inline bool operator==(const CRGB &lhs, const CRGB &rhs)
+{
+  return (lhs.r == rhs.r) && (lhs.g == rhs.g) && (lhs.b == rhs.b);
+}
+
+inline bool operator!=(const CRGB &lhs, const CRGB &rhs)
+{
+  return !(lhs == rhs);
+}
+
+inline void fill_solid(CRGB *leds, int numToFill, const CRGB &color)
+{
+  for (int i = 0; i < numToFill; i++)
+    leds[i] = color;
+}
+
+// ---------- Palettes ----------
+
+typedef uint32_t TProgmemRGBPalette16[16];
+
+enum TBlendType
+{
+  NOBLEND = 0,
+  LINEARBLEND = 1
+};
+
+class CRGBPalette16
+{
+public:
+  CRGB entries[16];
+
+  CRGBPalette16() {}
+  CRGBPalette16(const TProgmemRGBPalette16 &rhs)
+  {
+    for (uint8_t i = 0; i < 16; i++)
+      entries[i] = CRGB(rhs[i]);
+  }
+  CRGBPalette16(const CRGB &c1, const CRGB &c2, const CRGB &c3, const CRGB &c4);
+
+  CRGB &operator[](uint8_t x) { return entries[x]; }
+  const CRGB &operator[](uint8_t x) const { return entries[x]; }
+};
+
+CRGB ColorFromPalette(const CRGBPalette16 &pal, uint8_t index, uint8_t brightness = 255, TBlendType blendType = LINEARBLEND);
+
+extern const TProgmemRGBPalette16 CloudColors_p;
+extern const TProgmemRGBPalette16 LavaColors_p;
+extern const TProgmemRGBPalette16 OceanColors_p;
+extern const TProgmemRGBPalette16 ForestColors_p;
+extern const TProgmemRGBPalette16 RainbowColors_p;
+extern const TProgmemRGBPalette16 PartyColors_p;
+extern const TProgmemRGBPalette16 HeatColors_p;
+
+// ---------- Timing ----------
+
+class CEveryNMillis
+{
+private:
+  uint32_t _period;
+  uint32_t _prevTrigger;
+
+public:
+  explicit CEveryNMillis(uint32_t period) : _period(period), _prevTrigger(millis()) {}
+
+  bool ready()
+  {
+    uint32_t now = millis();
+    if (now - _prevTrigger < _period)
+      return false;
+    _prevTrigger = now;
+    return true;
+  }
+};
+
+#define EVERY_N_MILLIS_CONCAT2(a, b) a##b
+#define EVERY_N_MILLIS_CONCAT(a, b) EVERY_N_MILLIS_CONCAT2(a, b)
+#define EVERY_N_MILLIS(N)                                                   \
+  static CEveryNMillis EVERY_N_MILLIS_CONCAT(everyNMillis, __LINE__)(N);   \
+  if (EVERY_N_MILLIS_CONCAT(everyNMillis, __LINE__).ready())
+
+// ---------- Controller ----------
+
+class CFastLED
+{
+private:
+  CRGB *_leds = nullptr;
+  uint16_t _numLeds = 0;
+  uint8_t _brightness = 255;
+  uint32_t _frames = 0;
+
+public:
+  void addLeds(CRGB *leds, uint16_t count)
+  {
+    _leds = leds;
+    _numLeds = count;
+  }
+
+  void show() { _frames++; }
+  void show(uint8_t scale) { _frames++; }
+  void clear(bool writeData = false)
+  {
+    if (_leds)
+      memset8(_leds, 0, sizeof(CRGB) * _numLeds);
+    if (writeData)
+      show();
+  }
+
+  void setBrightness(uint8_t scale) { _brightness = scale; }
+  uint8_t getBrightness() const { return _brightness; }
+
+  uint32_t getFrameCount() const { return _frames; }
+};
+
+extern CFastLED FastLED;
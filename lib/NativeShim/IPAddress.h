@@ -0,0 +1,37 @@
+/*
+ * Minimal IPAddress replacement for the native (host) build.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+class IPAddress
+{
+private:
+  uint8_t _address[4];
+
+public:
+  IPAddress() : _address{0, 0, 0, 0} {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _address{a, b, c, d} {}
+
+  bool fromString(const char *address)
+  {
+    unsigned int a, b, c, d;
+    char end;
+    if ((sscanf(address, "%u.%u.%u.%u%c", &a, &b, &c, &d, &end) != 4) || (a > 255) || (b > 255) || (c > 255) || (d > 255))
+      return false;
+    _address[0] = a;
+    _address[1] = b;
+    _address[2] = c;
+    _address[3] = d;
+    return true;
+  }
+
+  uint8_t operator[](int index) const { return _address[index]; }
+  bool operator==(const IPAddress &other) const { return memcmp(_address, other._address, sizeof(_address)) == 0; }
+  bool operator!=(const IPAddress &other) const { return !(*this == other); }
+};
@@ -0,0 +1,279 @@
+/*
+ * Minimal Arduino/FastLED replacement for the native (host) build.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include "Arduino.h"
+#include "FastLED.h"
+
+// ---------- Arduino ----------
+
+static unsigned long _nativeMillis = 0;
+
+unsigned long millis()
+{
+  return _nativeMillis;
+}
+
+unsigned long micros()
+{
+  return _nativeMillis * 1000UL;
+}
+
+void delay(unsigned long ms)
+{
+  _nativeMillis += ms;
+}
+
+void yield()
+{
+}
+
+void nativeSetMillis(unsigned long ms)
+{
+  _nativeMillis = ms;
+}
+
+void nativeAdvanceMillis(unsigned long ms)
+{
+  _nativeMillis += ms;
+}
+
+long random(long howbig)
+{
+  if (howbig == 0)
+    return 0;
+  return rand() % howbig;
+}
+
+long random(long howsmall, long howbig)
+{
+  if (howsmall >= howbig)
+    return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed)
+{
+  if (seed != 0)
+    srand(seed);
+}
+
+// ---------- FastLED math ----------
+
+static uint16_t _rand16seed = 1337;
+
+uint8_t random8()
+{
+  _rand16seed = (_rand16seed * 2053) + 13849;
+  return (uint8_t)(((uint8_t)(_rand16seed & 0xFF)) + ((uint8_t)(_rand16seed >> 8)));
+}
+
+uint8_t random8(uint8_t lim)
+{
+  return ((uint16_t)random8() * lim) >> 8;
+}
+
+uint8_t random8(uint8_t min, uint8_t lim)
+{
+  return random8(lim - min) + min;
+}
+
+uint16_t random16()
+{
+  _rand16seed = (_rand16seed * 2053) + 13849;
+  return _rand16seed;
+}
+
+uint16_t random16(uint16_t lim)
+{
+  return ((uint32_t)random16() * lim) >> 16;
+}
+
+void random16_set_seed(uint16_t seed)
+{
+  _rand16seed = seed;
+}
+
+int16_t sin16(uint16_t theta)
+{
+  return (int16_t)(sin(theta * (2.0 * M_PI / 65536.0)) * 32767.0);
+}
+
+int16_t cos16(uint16_t theta)
+{
+  return sin16(theta + 16384);
+}
+
+// ---------- Colors ----------
+
+void hsv2rgb_rainbow(const CHSV &hsv, CRGB &rgb)
+{
+  uint8_t hue = hsv.hue;
+  uint8_t sat = hsv.sat;
+  uint8_t val = hsv.val;
+
+  uint8_t offset8 = (hue & 0x1F) << 3;
+  uint8_t third = scale8(offset8, (256 / 3));
+  uint8_t twothirds = scale8(offset8, ((256 * 2) / 3));
+  uint8_t r, g, b;
+
+  switch (hue >> 5)
+  {
+  case 0: // R -> O
+    r = 255 - third, g = third, b = 0;
+    break;
+  case 1: // O -> Y
+    r = 171, g = 85 + third, b = 0;
+    break;
+  case 2: // Y -> G
+    r = 171 - twothirds, g = 170 + third, b = 0;
+    break;
+  case 3: // G -> A
+    r = 0, g = 255 - third, b = third;
+    break;
+  case 4: // A -> B
+    r = 0, g = 171 - twothirds, b = 85 + twothirds;
+    break;
+  case 5: // B -> P
+    r = third, g = 0, b = 255 - third;
+    break;
+  case 6: // P -> K
+    r = 85 + third, g = 0, b = 171 - third;
+    break;
+  default: // K -> R
+    r = 170 + third, g = 0, b = 85 - third;
+    break;
+  }
+
+  if (sat != 255)
+  {
+    if (sat == 0)
+    {
+      r = g = b = 255;
+    }
+    else
+    {
+      uint8_t desat = 255 - sat;
+      desat = scale8_video(desat, desat);
+      uint8_t satscale = 255 - desat;
+      r = scale8(r, satscale) + desat;
+      g = scale8(g, satscale) + desat;
+      b = scale8(b, satscale) + desat;
+    }
+  }
+
+  if (val != 255)
+  {
+    val = scale8_video(val, val);
+    if (val == 0)
+    {
+      r = g = b = 0;
+    }
+    else
+    {
+      r = scale8_video(r, val);
+      g = scale8_video(g, val);
+      b = scale8_video(b, val);
+    }
+  }
+
+  rgb.r = r;
+  rgb.g = g;
+  rgb.b = b;
+}
+
+CRGBPalette16::CRGBPalette16(const CRGB &c1, const CRGB &c2, const CRGB &c3, const CRGB &c4)
+{
+  // Four evenly spaced gradient stops, like fill_gradient_RGB(entries, 0, c1, 5, c2, 10, c3, 15, c4)
+  const CRGB stops[4] = {c1, c2, c3, c4};
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    uint8_t seg = (i < 15) ? i / 5 : 2;
+    uint8_t f = ((i - seg * 5) * 255) / 5;
+    const CRGB &a = stops[seg];
+    const CRGB &b = stops[seg + 1];
+    entries[i] = CRGB(a.r + (((int)b.r - a.r) * f) / 255,
+                      a.g + (((int)b.g - a.g) * f) / 255,
+                      a.b + (((int)b.b - a.b) * f) / 255);
+  }
+}
+
+CRGB ColorFromPalette(const CRGBPalette16 &pal, uint8_t index, uint8_t brightness, TBlendType blendType)
+{
+  uint8_t hi4 = index >> 4;
+  uint8_t lo4 = index & 0x0F;
+
+  const CRGB &entry = pal[hi4];
+  uint8_t red1 = entry.r;
+  uint8_t green1 = entry.g;
+  uint8_t blue1 = entry.b;
+
+  if (lo4 && (blendType != NOBLEND))
+  {
+    const CRGB &next = pal[(hi4 == 15) ? 0 : hi4 + 1];
+    uint8_t f2 = lo4 << 4;
+    uint8_t f1 = 255 - f2;
+
+    red1 = scale8(red1, f1) + scale8(next.r, f2);
+    green1 = scale8(green1, f1) + scale8(next.g, f2);
+    blue1 = scale8(blue1, f1) + scale8(next.b, f2);
+  }
+
+  if (brightness != 255)
+  {
+    red1 = scale8_video(red1, brightness);
+    green1 = scale8_video(green1, brightness);
+    blue1 = scale8_video(blue1, brightness);
+  }
+
+  return CRGB(red1, green1, blue1);
+}
+
+const TProgmemRGBPalette16 CloudColors_p = {
+    CRGB::Blue, CRGB::DarkBlue, CRGB::DarkBlue, CRGB::DarkBlue,
+    CRGB::DarkBlue, CRGB::DarkBlue, CRGB::DarkBlue, CRGB::DarkBlue,
+    CRGB::Blue, CRGB::DarkBlue, CRGB::SkyBlue, CRGB::SkyBlue,
+    CRGB::LightBlue, CRGB::White, CRGB::LightBlue, CRGB::SkyBlue};
+
+const TProgmemRGBPalette16 LavaColors_p = {
+    CRGB::Black, CRGB::Maroon, CRGB::Black, CRGB::Maroon,
+    CRGB::DarkRed, CRGB::DarkRed, CRGB::Maroon, CRGB::DarkRed,
+    CRGB::DarkRed, CRGB::DarkRed, CRGB::Red, CRGB::Orange,
+    CRGB::White, CRGB::Orange, CRGB::Red, CRGB::DarkRed};
+
+const TProgmemRGBPalette16 OceanColors_p = {
+    CRGB::MidnightBlue, CRGB::DarkBlue, CRGB::MidnightBlue, CRGB::Navy,
+    CRGB::DarkBlue, CRGB::MediumBlue, CRGB::SeaGreen, CRGB::Teal,
+    CRGB::CadetBlue, CRGB::Blue, CRGB::DarkCyan, CRGB::CornflowerBlue,
+    CRGB::Aquamarine, CRGB::SeaGreen, CRGB::Aqua, CRGB::LightSkyBlue};
+
+const TProgmemRGBPalette16 ForestColors_p = {
+    CRGB::DarkGreen, CRGB::DarkGreen, CRGB::DarkOliveGreen, CRGB::DarkGreen,
+    CRGB::Green, CRGB::ForestGreen, CRGB::OliveDrab, CRGB::Green,
+    CRGB::SeaGreen, CRGB::MediumAquamarine, CRGB::LimeGreen, CRGB::YellowGreen,
+    CRGB::LightGreen, CRGB::LawnGreen, CRGB::MediumAquamarine, CRGB::ForestGreen};
+
+const TProgmemRGBPalette16 RainbowColors_p = {
+    0xFF0000, 0xD52A00, 0xAB5500, 0xAB7F00,
+    0xABAB00, 0x56D500, 0x00FF00, 0x00D52A,
+    0x00AB55, 0x0056AA, 0x0000FF, 0x2A00D5,
+    0x5500AB, 0x7F0081, 0xAB0055, 0xD5002B};
+
+const TProgmemRGBPalette16 PartyColors_p = {
+    0x5500AB, 0x84007C, 0xB5004B, 0xE5001B,
+    0xE81700, 0xB84700, 0xAB7700, 0xABAB00,
+    0xAB5500, 0xDD2200, 0xF2000E, 0xC2003E,
+    0x8F0071, 0x5F00A1, 0x2F00D0, 0x0007F9};
+
+const TProgmemRGBPalette16 HeatColors_p = {
+    0x000000, 0x330000, 0x660000, 0x990000,
+    0xCC0000, 0xFF0000, 0xFF3300, 0xFF6600,
+    0xFF9900, 0xFFCC00, 0xFFFF00, 0xFFFF33,
+    0xFFFF66, 0xFFFF99, 0xFFFFCC, 0xFFFFFF};
+
+// ---------- Controller ----------
+
+CFastLED FastLED;
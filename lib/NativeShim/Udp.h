@@ -0,0 +1,32 @@
+/*
+ * Minimal UDP interface of the Arduino core for the native (host) build.
+ *
+ * There is no network on the host, a simulation derives from UDP and answers the packets itself.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+class UDP
+{
+public:
+  virtual ~UDP() {}
+
+  virtual uint8_t begin(uint16_t port) = 0;
+  virtual void stop() = 0;
+
+  virtual int beginPacket(IPAddress ip, uint16_t port) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) = 0;
+  virtual int endPacket() = 0;
+
+  // Skips the rest of the current packet and returns the size of the next one, 0 if there is none
+  virtual int parsePacket() = 0;
+  virtual int read(uint8_t *buffer, size_t len) = 0;
+  virtual IPAddress remoteIP() = 0;
+  virtual uint16_t remotePort() = 0;
+};
@@ -12,173 +12,232 @@
 
 // ---------- BorealisWave ----------
 
-BorealisWave::BorealisWave(uint16_t numLeds) : _numLeds(numLeds)
+// List of colors allowed for waves.
+// The dimension of this array must match the second dimension of the color weighting array
+static const uint8_t ALLOWED_COLORS[][3] PROGMEM = {
+    {17, 177, 13},   // Greenish
+    {148, 242, 5},   // Greenish
+    {25, 173, 121},  // Turquoise
+    {250, 77, 127},  // Pink
+    {171, 101, 221}, // Purple
+};
+
+// Color weighting allows to give some colors more weight so it is more likely to be choosen for a wave.
+// The second dimension of this array must match the dimension of the allowed colors array
+// Here are 3 presets.
+static const uint8_t COLOR_WEIGHTING[][5] PROGMEM = {
+    {10, 10, 10, 10, 10}, // Weighting equal (every color is equally likely)
+    {2, 2, 2, 6, 6},      // Weighting reddish (red colors are more likely)
+    {6, 6, 6, 2, 2}       // Weighting greenish (green colors are more likely)
+};
+
+void BorealisWave::spawn(uint16_t length, bool curtain)
 {
-  _ttl = random(500, 1501);
+  // Same sequence of random numbers as the original, so the pattern stays the same
+  _ttl = random(500, 1501) * W_FRAME_MS;
   _basecolor = getWeightedColor(W_COLOR_WEIGHT_PRESET);
-  _basealpha = random(50, 101) / (float)100;
+  _basealpha = random(50, 101) * 255 / 100;
   _age = 0;
-  _width = random(_numLeds / 10, _numLeds / W_WIDTH_FACTOR);
-  _center = random(101) / (float)100 * _numLeds;
-  _goingleft = random(0, 2) == 0;
-  _speed = random(10, 30) / (float)100 * W_SPEED_FACTOR;
-  _alive = true;
+  if (curtain)
+    // The matrix is narrow, a curtain covers at least three columns
+    _halfWidth = random(384, ((uint32_t)length << 8) / W_WIDTH_FACTOR + 385);
+  else
+    _halfWidth = max(random(length / 10, length / W_WIDTH_FACTOR) / 2, 1L) << 8;
+  _center = ((int32_t)random(101) << 16) / 100 * length;
+  bool goingLeft = random(0, 2) == 0;
+  _speed = ((int32_t)random(10, 30) * W_SPEED_FACTOR << 16) / (100 * W_FRAME_MS);
+  if (curtain)
+    _speed /= W_CURTAIN_SLOWDOWN;
+  if (goingLeft)
+    _speed = -_speed;
 }
 
 uint8_t BorealisWave::getWeightedColor(uint8_t weighting)
 {
   uint8_t sumOfWeights = 0;
 
-  for (uint8_t i = 0; i < sizeof colorweighting[0]; i++)
+  for (uint8_t i = 0; i < sizeof COLOR_WEIGHTING[0]; i++)
   {
-    sumOfWeights += colorweighting[weighting][i];
+    sumOfWeights += pgm_read_byte(&COLOR_WEIGHTING[weighting][i]);
   }
 
   uint8_t randomweight = random(0, sumOfWeights);
 
-  for (uint8_t i = 0; i < sizeof colorweighting[0]; i++)
+  for (uint8_t i = 0; i < sizeof COLOR_WEIGHTING[0]; i++)
   {
-    if (randomweight < colorweighting[weighting][i])
+    uint8_t weight = pgm_read_byte(&COLOR_WEIGHTING[weighting][i]);
+    if (randomweight < weight)
     {
       return i;
     }
 
-    randomweight -= colorweighting[weighting][i];
+    randomweight -= weight;
   }
   return 0;
 }
 
-CRGB *BorealisWave::getColorForLED(int ledIndex)
+bool BorealisWave::update(uint16_t length, unsigned long elapsed)
 {
-  if (ledIndex < _center - _width / 2 || ledIndex > _center + _width / 2)
-  {
-    //Position out of range of this wave
-    return NULL;
-  }
-  else
-  {
-    //Offset of this led from center of wave
-    //The further away from the center, the dimmer the LED
-    int offset = abs(ledIndex - _center);
-    float offsetFactor = (float)offset / (_width / 2);
-
-    //The age of the wave determines it brightness.
-    //At half its maximum age it will be the brightest.
-    float ageFactor = 1;
-    if ((float)_age / _ttl < 0.5)
-    {
-      ageFactor = (float)_age / (_ttl / 2);
-    }
-    else
-    {
-      ageFactor = (float)(_ttl - _age) / ((float)_ttl * 0.5);
-    }
+  _center += _speed * (int32_t)elapsed;
+  _age += elapsed;
 
-    // Calculate color based on above factors and basealpha value
-    float brightness = (1 - offsetFactor) * ageFactor * _basealpha;
-    CRGB *rgb = new CRGB(allowedcolors[_basecolor]);
-    rgb->r *= brightness;
-    rgb->g *= brightness;
-    rgb->b *= brightness;
+  if (_age > _ttl)
+    return false;
 
-    return rgb;
-  }
+  int32_t halfWidth = (int32_t)_halfWidth << 8;
+  if (_speed < 0)
+    return _center + halfWidth >= 0;
+  return _center - halfWidth <= ((int32_t)length << 16);
 }
 
-void BorealisWave::update()
+void BorealisWave::draw(CRGB *leds, uint16_t length, uint8_t density) const
 {
-  if (_goingleft)
+  // The age of the wave determines its brightness. At half its maximum age it will be the brightest.
+  uint32_t halfTtl = _ttl / 2;
+  uint32_t ageLeft = (_age < halfTtl) ? _age : _ttl - _age;
+  uint8_t level = min((uint32_t)ageLeft * _basealpha / halfTtl, (uint32_t)255);
+  if (level == 0)
+    return;
+
+  // Only the LEDs within half the width of the center are lit
+  int32_t halfWidth = (int32_t)_halfWidth << 8;
+  int32_t first = max((_center - halfWidth + 0xFFFF) >> 16, (int32_t)0);
+  int32_t last = min((_center + halfWidth) >> 16, (int32_t)length - 1);
+
+  // Rounded up to the next used LED
+  first = (first + density - 1) / density * density;
+
+  // The further away from the center, the dimmer the LED. Q16 brightness per Q8.8 distance.
+  uint32_t step = ((uint32_t)level << 16) / _halfWidth;
+  CRGB color(pgm_read_byte(&ALLOWED_COLORS[_basecolor][0]),
+             pgm_read_byte(&ALLOWED_COLORS[_basecolor][1]),
+             pgm_read_byte(&ALLOWED_COLORS[_basecolor][2]));
+
+  for (int32_t i = first; i <= last; i += density)
   {
-    _center -= _speed;
-  }
-  else
-  {
-    _center += _speed;
+    uint16_t distance = abs((i << 16) - _center) >> 8;
+    uint8_t brightness = ((uint32_t)(_halfWidth - distance) * step) >> 16;
+    leds[i] += CRGB(color).nscale8(brightness);
   }
+}
 
-  _age++;
+// ---------- BorealisAnimation ----------
 
-  if (_age > _ttl)
+BorealisAnimation::BorealisAnimation(const ILedMatrix *ledMatrix, CRGB *leds, uint16_t count)
+    : LedEffect(leds, count),
+      _ledMatrix(ledMatrix),
+      _curtains(W_CURTAINS)
+{
+  uint8_t width = _ledMatrix->getWidth();
+  _columnColors = new CRGB[width];
+  _columnTops = new uint32_t[width];
+  _columnTargets = new uint32_t[width];
+  for (uint8_t x = 0; x < width; x++)
   {
-    _alive = false;
+    _columnTops[x] = (uint32_t)_ledMatrix->getHeight() << 16;
+    _columnTargets[x] = _columnTops[x];
   }
-  else
+  setFrameRate(W_FRAME_RATE);
+
+  randomSeed(W_RANDOM_SEED);
+  spawnWaves();
+}
+
+BorealisAnimation::~BorealisAnimation()
+{
+  delete[] _columnColors;
+  delete[] _columnTops;
+  delete[] _columnTargets;
+}
+
+void BorealisAnimation::setCurtains(bool value)
+{
+  if (value == _curtains)
+    return;
+
+  // Curtains leave the LEDs outside of the matrix dark
+  _curtains = value;
+  memset8(_leds, 0, sizeof(struct CRGB) * _numLeds);
+  spawnWaves();
+}
+
+// Initial creating of waves
+void BorealisAnimation::spawnWaves()
+{
+  for (int i = 0; i < W_COUNT; i++)
   {
-    if (_goingleft)
-    {
-      if (_center + _width / 2 < 0)
-      {
-        _alive = false;
-      }
-    }
-    else
-    {
-      if (_center - _width / 2 > _numLeds)
-      {
-        _alive = false;
-      }
-    }
+    _waves[i].spawn(getLength(), _curtains);
   }
 }
 
-// ---------- BorealisAnimation ----------
-
-BorealisAnimation::BorealisAnimation(const ILedMatrix *ledMatrix, CRGB *leds, uint16_t count)
-    : LedEffect(leds, count)
-    // , _ledMatrix(ledMatrix)
+void BorealisAnimation::updateWaves(unsigned long elapsed)
 {
-  randomSeed(W_RANDOM_SEED);
-  //Initial creating of waves
   for (int i = 0; i < W_COUNT; i++)
   {
-    waves[i] = new BorealisWave(_numLeds);
+    // If a wave dies, a new one takes its place
+    if (!_waves[i].update(getLength(), elapsed))
+    {
+      _waves[i].spawn(getLength(), _curtains);
+    }
   }
 }
 
-bool BorealisAnimation::paint(bool force)
+bool BorealisAnimation::paint(unsigned long elapsed, bool force)
 {
-  DrawWaves();
+  updateWaves(elapsed);
+  if (_curtains)
+    DrawCurtains(elapsed);
+  else
+    DrawWaves();
   return true;
 }
 
 void BorealisAnimation::DrawWaves()
 {
-  for (int i = 0; i < W_COUNT; i++)
+  for (int i = 0; i < _numLeds; i += LED_DENSITY)
   {
-    // Update values of wave
-    waves[i]->update();
-
-    if (!(waves[i]->stillAlive()))
-    {
-      // If a wave dies, remove it from memory and spawn a new one
-      delete waves[i];
-      waves[i] = new BorealisWave(_numLeds);
-    }
+    _leds[i] = CRGB::Black;
   }
 
-  // Loop through LEDs to determine color
-  for (int i = 0; i < _numLeds; i++)
+  // If there are multiple waves on a LED their colors add up
+  for (int i = 0; i < W_COUNT; i++)
   {
-    if (i % LED_DENSITY != 0)
-    {
-      continue;
-    }
+    _waves[i].draw(_leds, _numLeds, LED_DENSITY);
+  }
+}
 
-    CRGB mixedRgb = CRGB::Black;
+void BorealisAnimation::DrawCurtains(unsigned long elapsed)
+{
+  uint8_t width = _ledMatrix->getWidth();
+  uint8_t height = _ledMatrix->getHeight();
 
-    // For each LED we must check each wave if it is "active" at this position.
-    // If there are multiple waves active on a LED we multiply their values.
-    for (int j = 0; j < W_COUNT; j++)
-    {
-      CRGB *rgb = waves[j]->getColorForLED(i);
+  memset8(_columnColors, 0, sizeof(struct CRGB) * width);
+  for (int i = 0; i < W_COUNT; i++)
+  {
+    _waves[i].draw(_columnColors, width, 1);
+  }
 
-      if (rgb != NULL)
-      {
-        mixedRgb += *rgb;
-      }
+  for (uint8_t x = 0; x < width; x++)
+  {
+    // The top of each column drifts up and down on its own
+    uint32_t &top = _columnTops[x];
+    uint32_t &target = _columnTargets[x];
+    uint32_t delta = min((target > top) ? target - top : top - target,
+                         ((uint32_t)elapsed << 16) / (W_CURTAIN_TOP_SPEED * W_FRAME_MS));
+    if (target == top)
+      target = (uint32_t)random((height << 8) / W_CURTAIN_MIN_TOP, (height << 8) * 5 / 4 + 1) << 8;
+    else
+      top += (target > top) ? delta : -delta;
 
-      delete[] rgb;
+    // Brightest at the bottom, fading out faster and faster up to the top
+    CRGB color = _columnColors[x];
+    uint16_t fadeOut = top >> 8; // Q8.8
+    uint32_t step = (255UL << 16) / fadeOut;
+    for (uint8_t y = 0; y < height; y++)
+    {
+      uint16_t row = (y << 8) + 128; // Center of the pixel
+      uint8_t fraction = (row < fadeOut) ? ((uint32_t)row * step) >> 16 : 255;
+      _leds[_ledMatrix->xy(x, y)] = CRGB(color).nscale8(255 - scale8(fraction, fraction));
     }
-    _leds[i] = mixedRgb;
   }
 }
@@ -16,6 +16,10 @@
 // LED CONFIG
 #define LED_DENSITY 1 //1 = Every LED is used, 2 = Every second LED is used.. and so on
 
+// FRAME CONFIG
+#define W_FRAME_RATE 50         //Frames per second, the waves move at the same speed at any frame rate
+#define W_FRAME_MS 20           //Speeds and life times below are given per frame of this length
+
 // WAVE CONFIG
 #define W_COUNT 8               //Number of simultaneous waves
 #define W_SPEED_FACTOR 3        //Higher number, higher speed
@@ -23,62 +27,64 @@
 #define W_COLOR_WEIGHT_PRESET 1 //What color weighting to choose
 #define W_RANDOM_SEED 11        //Change this seed for a different pattern. If you read from an analog input here you can get a different pattern everytime.
 
+// CURTAIN CONFIG
+#define W_CURTAINS 1            //1 = Vertical curtains over the matrix, 0 = Waves along the LED strip
+#define W_CURTAIN_SLOWDOWN 8    //Curtains move this much slower than waves, the matrix is only a few columns wide
+#define W_CURTAIN_MIN_TOP 2     //Curtains reach up at least to 1/2 of the height and at most 1/4 above it ...
+#define W_CURTAIN_TOP_SPEED 24  //... and their top moves by 1/24 row per W_FRAME_MS
+
+// The waves are kept in fixed point, the ESP8266 has no FPU.
+// Positions and speeds are Q16.16, the half width is Q8.8, brightness values are 0..255, times are ms.
+// A wave runs along the LED strip, or across the columns of the matrix as a curtain.
 class BorealisWave
 {
 private:
-  //List of colors allowed for waves
-  //The dimension of this array must match the second dimension of the colorwighting array
-  CRGB allowedcolors[5] = {
-      CRGB(17, 177, 13),   //Greenish
-      CRGB(148, 242, 5),   //Greenish
-      CRGB(25, 173, 121),  //Turquoise
-      CRGB(250, 77, 127),  //Pink
-      CRGB(171, 101, 221), //Purple
-  };
-
-  //Colorweighing allows to give some colors more weight so it is more likely to be choosen for a wave.
-  //The second dimension of this array must match the dimension of the allowedcolors array
-  //Here are 3 presets.
-  byte colorweighting[3][5] = {
-      {10, 10, 10, 10, 10}, //Weighting equal (every color is equally likely)
-      {2, 2, 2, 6, 6},      //Weighting reddish (red colors are more likely)
-      {6, 6, 6, 2, 2}       //Weighting greenish (green colors are more likely)
-  };
-
-  uint16_t _numLeds;
-  int _ttl;
-  byte _basecolor;
-  float _basealpha;
-  int _age;
-  int _width;
-  float _center;
-  bool _goingleft;
-  float _speed;
-  bool _alive;
-
-  uint8_t getWeightedColor(uint8_t weighting);
+  int32_t _center;     // Q16.16
+  int32_t _speed;      // Q16.16 per ms, negative when the wave goes left
+  uint16_t _halfWidth; // Q8.8 on each side of the center
+  uint32_t _ttl;       // Time until the wave dies
+  uint32_t _age;
+  uint8_t _basecolor;  // Index into the allowed colors
+  uint8_t _basealpha;
+
+  static uint8_t getWeightedColor(uint8_t weighting);
 
 public:
-  explicit BorealisWave(uint16_t numLeds);
+  // Starts a new wave somewhere within length LEDs or columns
+  void spawn(uint16_t length, bool curtain);
 
-  CRGB *getColorForLED(int ledIndex);
+  // Moves and ages the wave by elapsed ms, returns false if it has died
+  bool update(uint16_t length, unsigned long elapsed);
 
-  //Change position and age of wave
-  //Determine if its still "alive"
-  void update();
-  bool stillAlive() { return _alive; };
+  // Adds the wave over its span to every density'th of length LEDs, with saturation
+  void draw(CRGB *leds, uint16_t length, uint8_t density) const;
 };
 
 class BorealisAnimation : public LedEffect
 {
 private:
-  // const ILedMatrix *_ledMatrix;
-  BorealisWave *waves[W_COUNT];
+  const ILedMatrix *_ledMatrix;
+  BorealisWave _waves[W_COUNT]; // Dead waves are spawned again in place
+  bool _curtains;
 
+  // Curtains are drawn column by column: the waves only add up the color of each column,
+  // then each column is faded out towards its top.
+  CRGB *_columnColors;
+  uint32_t *_columnTops;    // Q16.16 row at which each column has faded out ...
+  uint32_t *_columnTargets; // ... and where that top is heading
+
+  uint16_t getLength() const { return _curtains ? _ledMatrix->getWidth() : _numLeds; }
+  void spawnWaves();
+  void updateWaves(unsigned long elapsed);
   void DrawWaves();
+  void DrawCurtains(unsigned long elapsed);
 
 public:
   explicit BorealisAnimation(const ILedMatrix *ledMatrix, CRGB *leds, uint16_t count);
+  ~BorealisAnimation();
+
+  bool paint(unsigned long elapsed, bool force) override;
 
-  bool paint(bool force);
+  void setCurtains(bool value);
+  bool getCurtains() { return _curtains; }
 };
@@ -0,0 +1,71 @@
+/*
+ * Sample history of one time server, modelled on the NTP clock filter.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include "ClockFilter.h"
+
+ClockFilter::ClockFilter()
+{
+  clear();
+}
+
+void ClockFilter::clear()
+{
+  _count = 0;
+  _next = 0;
+  _spikes = 0;
+}
+
+bool ClockFilter::add(const TSntpSample &sample, const TSntpClockFunction &clock)
+{
+  const TSntpSample *best = getBest(sample.atMillis);
+  if (best)
+  {
+    int64_t step = getOffset(sample, clock) - getOffset(*best, clock);
+    if ((step > CLOCK_FILTER_SPIKE_MS) || (step < -CLOCK_FILTER_SPIKE_MS))
+    {
+      if (++_spikes < CLOCK_FILTER_MAX_SPIKES)
+        return false;
+      // The server insists, the history no longer matches its time
+      clear();
+    }
+    else
+      _spikes = 0;
+  }
+
+  _samples[_next] = sample;
+  _next = (_next + 1) % CLOCK_FILTER_SIZE;
+  if (_count < CLOCK_FILTER_SIZE)
+    _count++;
+  return true;
+}
+
+const TSntpSample *ClockFilter::getBest(unsigned long now) const
+{
+  const TSntpSample *best = nullptr;
+  uint32_t bestDistance = UINT32_MAX;
+
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    uint32_t distance = getDistance(_samples[i], now);
+    if (distance < bestDistance)
+    {
+      best = &_samples[i];
+      bestDistance = distance;
+    }
+  }
+  return best;
+}
+
+int64_t ClockFilter::getOffset(const TSntpSample &sample, const TSntpClockFunction &clock)
+{
+  return (int64_t)sample.utc * 1000 + sample.ms - clock(sample.atMillis);
+}
+
+uint32_t ClockFilter::getDistance(const TSntpSample &sample, unsigned long now)
+{
+  return sample.rttMs + (uint64_t)(now - sample.atMillis) * CLOCK_FILTER_AGING_PPM / 1000000;
+}
@@ -0,0 +1,61 @@
+/*
+ * Sample history of one time server, modelled on the NTP clock filter.
+ *
+ * The sample with the shortest round trip is the most accurate one, because the
+ * asymmetry of the network delay can be at most half of the round trip. Older
+ * samples count as if their round trip was longer, so a stale sample is replaced
+ * by a fresh one in the long run.
+ *
+ * Offsets are measured against the local clock at the millis() of each sample, so
+ * samples of different age and different servers can be compared. A sample which is
+ * far off the best one in the history is an outlier and is dropped, unless the
+ * server keeps sending such samples. Then its time has really changed.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+#define CLOCK_FILTER_SIZE 8        // Samples kept per server, like NTP
+#define CLOCK_FILTER_SPIKE_MS 128  // Samples further off the best one are outliers (the NTP step threshold) ...
+#define CLOCK_FILTER_MAX_SPIKES 3  // ... unless this many arrive in a row
+#define CLOCK_FILTER_AGING_PPM 15  // An old sample counts as if its round trip was longer by this much of its age
+
+struct TSntpSample
+{
+  uint32_t utc;           // UTC seconds ...
+  uint16_t ms;            // ... and milliseconds ...
+  unsigned long atMillis; // ... at this millis()
+  uint16_t rttMs;         // Round trip time without the processing time on the server
+};
+
+// Local time in ms since 1970 at the given millis(), the offsets are measured against it
+typedef std::function<int64_t(unsigned long atMillis)> TSntpClockFunction;
+
+class ClockFilter
+{
+private:
+  TSntpSample _samples[CLOCK_FILTER_SIZE];
+  uint8_t _count;
+  uint8_t _next;   // Ring buffer index of the next sample
+  uint8_t _spikes; // Outliers in a row
+
+public:
+  ClockFilter();
+
+  void clear();
+  // Adds the sample to the history, returns false if it was dropped as outlier
+  bool add(const TSntpSample &sample, const TSntpClockFunction &clock);
+
+  // The sample with the shortest aged round trip, nullptr while the history is empty
+  const TSntpSample *getBest(unsigned long now) const;
+  uint8_t getCount() const { return _count; }
+
+  // Sample minus local time in ms
+  static int64_t getOffset(const TSntpSample &sample, const TSntpClockFunction &clock);
+  // Round trip time of the sample plus the aging penalty in ms
+  static uint32_t getDistance(const TSntpSample &sample, unsigned long now);
+};
@@ -0,0 +1,35 @@
+/*
+ * Color lookup tables shared by all effects.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include "ColorCache.h"
+
+ColorCache colorCache;
+
+const CRGB *ColorCache::getPalette(const CRGBPalette16 &palette, uint32_t key)
+{
+  if (!_palette)
+    _palette = new CRGB[COLOR_CACHE_SIZE];
+
+  if (key != _paletteKey)
+  {
+    for (uint16_t i = 0; i < COLOR_CACHE_SIZE; i++)
+      _palette[i] = ColorFromPalette(palette, i);
+    _paletteKey = key;
+  }
+  return _palette;
+}
+
+const CRGB *ColorCache::getHues()
+{
+  if (!_hues)
+  {
+    _hues = new CRGB[COLOR_CACHE_SIZE];
+    for (uint16_t i = 0; i < COLOR_CACHE_SIZE; i++)
+      _hues[i] = CHSV(i, 255, 255);
+  }
+  return _hues;
+}
@@ -0,0 +1,61 @@
+/*
+ * Color lookup tables shared by all effects.
+ *
+ * ColorFromPalette() interpolates between the 16 entries of a palette and CHSV -> CRGB
+ * runs the rainbow conversion, both on every call. The cache expands the palette of
+ * an effect into 256 ready colors and holds the full saturation and value color of
+ * every hue, so the effects only index a table per pixel.
+ *
+ * Only one palette is expanded at a time. Each palette assignment gets a new key,
+ * and the table is expanded again when an effect with a different key asks for it.
+ * As only one effect with a palette is painted at a time, this happens once per
+ * palette change or mode change. Both tables are allocated on first use and never freed.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include <FastLED.h>
+
+#define COLOR_CACHE_SIZE 256
+
+class ColorCache
+{
+private:
+  CRGB *_hues;          // CHSV(hue, 255, 255) for every hue
+  CRGB *_palette;       // The expanded palette ...
+  uint32_t _paletteKey; // ... and its key, 0 = none yet
+  uint32_t _nextKey;
+
+public:
+  // constexpr, so the global is constant initialized and ready before the constructors of the global effects run
+  constexpr ColorCache()
+      : _hues(nullptr),
+        _palette(nullptr),
+        _paletteKey(0),
+        _nextKey(0)
+  {
+  }
+
+  // A key for a newly assigned palette
+  uint32_t createKey() { return ++_nextKey; }
+
+  // 256 colors of the palette, expanded only if key isn't the expanded palette
+  const CRGB *getPalette(const CRGBPalette16 &palette, uint32_t key);
+
+  // 256 colors with full saturation and value, indexed by hue
+  const CRGB *getHues();
+
+  // CHSV(hue, 255, value), dimmed with the same curve as the rainbow conversion (within one step)
+  CRGB getHue(uint8_t hue, uint8_t value)
+  {
+    CRGB color = getHues()[hue];
+    if (value != 255)
+      color.nscale8_video(scale8_video(value, value));
+    return color;
+  }
+};
+
+extern ColorCache colorCache;
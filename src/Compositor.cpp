@@ -0,0 +1,150 @@
+/*
+ * Composites separate layer buffers into the LED output buffer.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include "Compositor.h"
+
+Compositor::Compositor(CRGB *output, uint16_t count)
+    : _output(output), _numLeds(count)
+{
+  for (uint8_t i = 0; i < LAYER_COUNT; i++)
+  {
+    // One extra pixel in front of each layer, see "safety pixel" in LedMatrix.h
+    _layers[i].leds = new CRGB[_numLeds + 1] + 1;
+    _layers[i].blendMode = (i == LAYER_BASE) ? BLEND_REPLACE : BLEND_OVER;
+    memset8((void *)_layers[i].leds, 0, sizeof(struct CRGB) * _numLeds);
+    _layers[i].dirty = false;
+    _layers[i].first = 0;
+    _layers[i].last = 0;
+    markDirty((TLAYER)i);
+  }
+}
+
+Compositor::~Compositor()
+{
+  for (uint8_t i = 0; i < LAYER_COUNT; i++)
+  {
+    delete[](_layers[i].leds - 1);
+  }
+}
+
+void Compositor::setBlendMode(TLAYER layer, TBLENDMODE mode)
+{
+  if (_layers[layer].blendMode != mode)
+  {
+    _layers[layer].blendMode = mode;
+    markDirty(layer);
+  }
+}
+
+void Compositor::markDirty(TLAYER layer)
+{
+  markDirty(layer, 0, _numLeds);
+}
+
+void Compositor::markDirty(TLAYER layer, uint16_t first, uint16_t count)
+{
+  if ((count == 0) || (first >= _numLeds))
+    return;
+
+  uint16_t last = first + count - 1;
+  if (last >= _numLeds)
+    last = _numLeds - 1;
+
+  TLayer &l = _layers[layer];
+  if (l.dirty)
+  {
+    if (first < l.first)
+      l.first = first;
+    if (last > l.last)
+      l.last = last;
+  }
+  else
+  {
+    l.dirty = true;
+    l.first = first;
+    l.last = last;
+  }
+}
+
+void Compositor::clear(TLAYER layer)
+{
+  memset8((void *)_layers[layer].leds, 0, sizeof(struct CRGB) * _numLeds);
+  markDirty(layer);
+}
+
+void Compositor::blend(const TLayer &layer, uint16_t first, uint16_t last)
+{
+  CRGB *src = layer.leds;
+
+  switch (layer.blendMode)
+  {
+  case BLEND_REPLACE:
+    memcpy8(&_output[first], &src[first], sizeof(struct CRGB) * (last - first + 1));
+    break;
+  case BLEND_OVER:
+    for (uint16_t i = first; i <= last; i++)
+    {
+      if (src[i])
+        _output[i] = src[i];
+    }
+    break;
+  case BLEND_ADD:
+    for (uint16_t i = first; i <= last; i++)
+    {
+      _output[i] += src[i];
+    }
+    break;
+  }
+}
+
+// FNV-1a over the bytes of the output pixels first..last
+uint32_t Compositor::getHash(uint16_t first, uint16_t last) const
+{
+  const uint8_t *data = (const uint8_t *)&_output[first];
+  const uint8_t *end = (const uint8_t *)&_output[last + 1];
+  uint32_t hash = 2166136261UL;
+  while (data < end)
+  {
+    hash ^= *data++;
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+bool Compositor::compose()
+{
+  uint16_t first = _numLeds;
+  uint16_t last = 0;
+
+  // Union of all dirty ranges
+  for (uint8_t i = 0; i < LAYER_COUNT; i++)
+  {
+    if (_layers[i].dirty)
+    {
+      if (_layers[i].first < first)
+        first = _layers[i].first;
+      if (_layers[i].last > last)
+        last = _layers[i].last;
+      _layers[i].dirty = false;
+    }
+  }
+
+  if (first > last)
+    return false;
+
+  uint32_t before = getHash(first, last);
+
+  // The bottom layer defines the pixels, unless it is blended itself
+  if (_layers[LAYER_BASE].blendMode != BLEND_REPLACE)
+    memset8((void *)&_output[first], 0, sizeof(struct CRGB) * (last - first + 1));
+
+  for (uint8_t i = 0; i < LAYER_COUNT; i++)
+  {
+    blend(_layers[i], first, last);
+  }
+  return getHash(first, last) != before;
+}
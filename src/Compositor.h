@@ -0,0 +1,68 @@
+/*
+ * Composites separate layer buffers into the LED output buffer.
+ *
+ * Base effects, the clock accents (minute and second LEDs) and the status overlay
+ * each draw into their own layer, so they can no longer overwrite each other.
+ * Each layer has a dirty range and a blend mode. compose() only blends the pixels
+ * inside the union of the dirty ranges, so a small overlay only costs a few pixels per frame.
+ * The dirty range of the output is hashed before and after blending, so a frame which
+ * was repainted with the same pixels is not reported as a change and not sent again.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include <FastLED.h>
+
+enum TLAYER
+{
+  LAYER_BASE,    // Active effect
+  LAYER_ACCENTS, // Minute and second LEDs of the word clock
+  LAYER_OVERLAY, // Status overlay
+  LAYER_COUNT
+};
+
+enum TBLENDMODE
+{
+  BLEND_REPLACE, // All pixels of the layer replace the pixels below
+  BLEND_OVER,    // Lit pixels of the layer replace the pixels below, black is transparent
+  BLEND_ADD      // Pixels of the layer are added to the pixels below
+};
+
+class Compositor
+{
+private:
+  struct TLayer
+  {
+    CRGB *leds;
+    TBLENDMODE blendMode;
+    bool dirty;
+    uint16_t first; // First dirty pixel
+    uint16_t last;  // Last dirty pixel
+  };
+
+  CRGB *const _output;
+  const uint16_t _numLeds;
+  TLayer _layers[LAYER_COUNT];
+
+  void blend(const TLayer &layer, uint16_t first, uint16_t last);
+  uint32_t getHash(uint16_t first, uint16_t last) const;
+
+public:
+  explicit Compositor(CRGB *output, uint16_t count);
+  ~Compositor();
+
+  // Each layer has the same size as the output and its own safety pixel at index -1
+  CRGB *getLayer(TLAYER layer) const { return _layers[layer].leds; }
+
+  void setBlendMode(TLAYER layer, TBLENDMODE mode);
+  void markDirty(TLAYER layer);
+  void markDirty(TLAYER layer, uint16_t first, uint16_t count);
+  void clear(TLAYER layer);
+
+  // Blends all dirty pixels into the output buffer.
+  // Returns true if any pixel of the output buffer has a different color than before.
+  bool compose();
+};
@@ -7,7 +7,8 @@
 #include "LedEffect.h"
 
 LedEffect::LedEffect(CRGB *leds, uint16_t count)
-    : _leds(leds), _numLeds(count), _currentPalette(RainbowColors_p)
+    : _leds(leds), _numLeds(count), _currentPalette(RainbowColors_p), _paletteKey(colorCache.createKey()),
+      _frameMs(0), _nextFrame(0), _lastFrame(0), _dirtyFirst(0), _dirtyEnd(0)
 {
 }
 
@@ -21,6 +22,45 @@ void LedEffect::init()
   memset8((void *)_leds, 0, sizeof(struct CRGB) * _numLeds);
 }
 
+bool LedEffect::update(bool force)
+{
+  unsigned long now = millis();
+  if (!force && (_frameMs > 0) && !isDue(_nextFrame, now))
+    return false;
+
+  unsigned long elapsed = force ? 0 : min(now - _lastFrame, (unsigned long)MAX_ELAPSED_MS);
+  _lastFrame = now;
+
+  // Keep the frames on their grid, unless they have fallen behind by a whole frame
+  _nextFrame += _frameMs;
+  if (force || isDue(_nextFrame, now))
+    _nextFrame = now + _frameMs;
+
+  _dirtyFirst = _numLeds;
+  _dirtyEnd = 0;
+  if (force)
+    markDirty(0, _numLeds);
+
+  // A forced frame always counts as a change, the caller has usually just cleared the pixels.
+  // Otherwise an effect with nothing visible at elapsed = 0 would be forced again and again.
+  bool result = paint(elapsed, force) || force;
+  if (result && (_dirtyFirst >= _dirtyEnd))
+    markDirty(0, _numLeds);
+  return result;
+}
+
+void LedEffect::markDirty(uint16_t first, uint16_t count)
+{
+  if ((count == 0) || (first >= _numLeds))
+    return;
+
+  uint16_t end = (count > _numLeds - first) ? _numLeds : first + count;
+  if (first < _dirtyFirst)
+    _dirtyFirst = first;
+  if (end > _dirtyEnd)
+    _dirtyEnd = end;
+}
+
 void LedEffect::createRandomPalette()
 {
   _randomPalette = CRGBPalette16(
@@ -30,13 +70,8 @@ void LedEffect::createRandomPalette()
       CHSV(random8(), 255, 255));
 }
 
-CRGB LedEffect::getColorFromPalette(uint8_t index)
-{
-  return ColorFromPalette(_currentPalette, index);
-}
-
 CRGB LedEffect::getRandomColor()
 {
   uint8_t index = random(0, 255);
-  return ColorFromPalette(_currentPalette, index);
+  return getColorFromPalette(index);
 }
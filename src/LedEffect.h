@@ -9,7 +9,13 @@
 
 #include <FastLED.h>
 
+#include "ColorCache.h"
+#include "Scheduler.h" // isDue()
+
 #define UPDATE_MS 50 // Update the display 20 times per second in order to follow the brightness changes quicker
+#define IDLE_MS 1000 // Deadline horizon of an effect which has nothing scheduled
+#define FRAME_RATE 50 // Default frames per second of the animations
+#define MAX_ELAPSED_MS 1000 // Longer gaps between two frames are cut short, so an animation doesn't jump
 
 class LedEffect
 {
@@ -18,23 +24,59 @@ protected:
 	const uint16_t _numLeds;
 	CRGBPalette16 _currentPalette;
 	CRGBPalette16 _randomPalette;
+	uint32_t _paletteKey; // Identifies _currentPalette in the color cache
+
+	// Frame clock, an effect without a frame rate paces itself and is painted on every update()
+	uint16_t _frameMs;
+	unsigned long _nextFrame;
+	unsigned long _lastFrame;
+
+	// Pixels changed by the last update(), _dirtyEnd is exclusive. Nothing is dirty while _dirtyFirst >= _dirtyEnd.
+	uint16_t _dirtyFirst;
+	uint16_t _dirtyEnd;
+
+	// Effects which only touch a few pixels report them here from paint(). If a paint() which
+	// returns true hasn't reported anything, all pixels are dirty.
+	void markDirty(uint16_t first, uint16_t count);
 
 	CRGB getRandomColor();
-	CRGB getColorFromPalette(uint8_t index);
+	CRGB getColorFromPalette(uint8_t index) { return getPaletteColors()[index]; }
+	// The current palette expanded to 256 colors, for effects which look up many pixels at once
+	const CRGB *getPaletteColors() { return colorCache.getPalette(_currentPalette, _paletteKey); }
 
 public:
 	explicit LedEffect(CRGB *leds, uint16_t count);
 	virtual ~LedEffect();
 
 	virtual void init();
-	virtual bool paint(bool force) = 0;
+
+	// Paints a frame when the frame clock is due or when forced to, returns true if the LEDs have changed.
+	// A forced frame always returns true.
+	// Frames which could not be painted in time are skipped, the next one covers the whole time since the last.
+	bool update(bool force);
+
+	// Advances the animation by elapsed ms and paints it, returns true if the LEDs have changed.
+	// Forced frames repaint the current state with elapsed = 0, e.g. after a mode change.
+	virtual bool paint(unsigned long elapsed, bool force) = 0;
+
+	// Range of pixels which the last update() has changed, count is 0 if nothing has changed
+	uint16_t getDirtyFirst() const { return (_dirtyFirst < _dirtyEnd) ? _dirtyFirst : 0; }
+	uint16_t getDirtyCount() const { return (_dirtyFirst < _dirtyEnd) ? _dirtyEnd - _dirtyFirst : 0; }
+
+	// millis() at which paint() has the next visible change. The main loop idles until the earliest deadline.
+	// Effects which don't know better are due with every frame, or all the time without a frame rate.
+	virtual unsigned long getNextUpdate() { return (_frameMs > 0) ? _nextFrame : millis(); }
+
+	// Frames per second, 0 leaves the pacing to the effect
+	void setFrameRate(uint8_t fps) { _frameMs = (fps > 0) ? 1000 / fps : 0; }
+	uint8_t getFrameRate() const { return (_frameMs > 0) ? 1000 / _frameMs : 0; }
 
 	void createRandomPalette();
 
 	void setPalette(CRGBPalette16 value)
 	{
 		_currentPalette = value;
-		paint(true);
+		_paletteKey = colorCache.createKey();
 	}
 
 	void setRandomPalette()
@@ -16,11 +16,27 @@
 
 class ILedMatrix
 {
+protected:
+  // Optional row-major (x,y) -> strip index table in flash.
+  // Layouts which are known at compile time set this, runtime layouts leave it empty.
+  const uint16_t *_lookup = nullptr;
+  uint8_t _lookupWidth = 0;
+
 public:
   virtual uint8_t getWidth() const = 0;
   virtual uint8_t getHeight() const = 0;
   virtual uint16_t getCount() const = 0;
   virtual int16_t toStrip(uint8_t x, uint8_t y) const = 0;
+
+  // Non-virtual fast path for effects that draw a lot of pixels.
+  // Uses the lookup table if the layout provides one and falls back to toStrip() otherwise.
+  // IT DOES NOT CHECK THE COORDINATE BOUNDARIES when the lookup table is used.
+  inline int16_t xy(uint8_t x, uint8_t y) const
+  {
+    if (_lookup)
+      return pgm_read_word(&_lookup[y * _lookupWidth + x]);
+    return toStrip(x, y);
+  }
 };
 
 // Set 'serpentineLayout' to false if your pixels are
@@ -188,3 +204,66 @@ public:
   uint16_t getCount() const { return _width * _height; }
   int16_t toStrip(uint8_t x, uint8_t y) const { return XYSafe(x, y); }
 };
+
+// Same layout rules as LedMatrix, but width, height and wiring are template parameters.
+// The (x,y) -> strip index table is computed by the compiler and stored in flash,
+// so effects can use the non-virtual ILedMatrix::xy() instead of branching on the layout for each pixel.
+//
+//    StaticLedMatrix<11, 10> ledMatrix;  // 11x10 pixels, serpentine, horizontal
+
+template <uint8_t W, uint8_t H, bool SERPENTINE = true, bool VERTICAL = false>
+class StaticLedMatrix : public ILedMatrix
+{
+private:
+  struct TLookup
+  {
+    uint16_t index[W * H];
+  };
+
+  // Compile time version of LedMatrix::XY()
+  static constexpr uint16_t XY(uint8_t x, uint8_t y)
+  {
+    if (SERPENTINE)
+    {
+      if (!VERTICAL)
+        return (y & 0x01) ? (y * W) + ((W - 1) - x) : (y * W) + x;
+      else
+        return (x & 0x01) ? H * (W - (x + 1)) + y : H * (W - x) - (y + 1);
+    }
+    else
+    {
+      if (!VERTICAL)
+        return (y * W) + x;
+      else
+        return H * (W - (x + 1)) + y;
+    }
+  }
+
+  static constexpr TLookup createLookup()
+  {
+    TLookup lookup{};
+    for (uint8_t y = 0; y < H; y++)
+      for (uint8_t x = 0; x < W; x++)
+        lookup.index[y * W + x] = XY(x, y);
+    return lookup;
+  }
+
+  static constexpr TLookup LOOKUP PROGMEM = createLookup();
+
+public:
+  StaticLedMatrix()
+  {
+    _lookup = LOOKUP.index;
+    _lookupWidth = W;
+  }
+
+  uint8_t getWidth() const { return W; }
+  uint8_t getHeight() const { return H; }
+  uint16_t getCount() const { return W * H; }
+  int16_t toStrip(uint8_t x, uint8_t y) const
+  {
+    if ((x >= W) || (y >= H))
+      return -1;
+    return pgm_read_word(&LOOKUP.index[y * W + x]);
+  }
+};
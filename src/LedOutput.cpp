@@ -0,0 +1,24 @@
+/*
+ * Output sinks for the composited LED frame.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include "LedOutput.h"
+
+// ---------- FastLedOutput ----------
+
+void FastLedOutput::submit(const CRGB *leds, uint16_t count, uint8_t brightness)
+{
+  FastLED.show(brightness);
+}
+
+// ---------- CaptureLedOutput ----------
+
+void CaptureLedOutput::submit(const CRGB *leds, uint16_t count, uint8_t brightness)
+{
+  _frame.assign(leds, leds + count);
+  _brightness = brightness;
+  _frameCount++;
+}
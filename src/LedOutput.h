@@ -0,0 +1,60 @@
+/*
+ * Output sinks for the composited LED frame.
+ *
+ * The main loop hands every finished frame to an ILedOutput. Synchronous backends
+ * transmit it before submit() returns, asynchronous backends copy the frame into
+ * their own buffer and transmit it in the background, so that the next frame can be
+ * painted while the current one is still on the wire.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include <FastLED.h>
+
+class ILedOutput
+{
+public:
+  virtual ~ILedOutput() {}
+
+  virtual void begin() {}
+
+  // Takes over a frame. The caller may modify leds as soon as this returns.
+  virtual void submit(const CRGB *leds, uint16_t count, uint8_t brightness) = 0;
+
+  // Starts the transmission of a frame that could not be sent by submit() because the previous one was still busy.
+  // Call this on every loop iteration.
+  virtual void update() {}
+
+  // True while a frame is being transmitted or waiting for transmission
+  virtual bool isBusy() const { return false; }
+};
+
+// Sends the frame with FastLED.show(). Blocks with interrupts disabled until the frame is out.
+// leds must be the buffer that was registered with FastLED.addLeds().
+class FastLedOutput : public ILedOutput
+{
+public:
+  void submit(const CRGB *leds, uint16_t count, uint8_t brightness) override;
+};
+
+// Keeps a copy of the last submitted frame, e.g. for host side tools and tests
+class CaptureLedOutput : public ILedOutput
+{
+private:
+  std::vector<CRGB> _frame;
+  uint8_t _brightness;
+  uint32_t _frameCount;
+
+public:
+  CaptureLedOutput() : _brightness(0), _frameCount(0) {}
+
+  void submit(const CRGB *leds, uint16_t count, uint8_t brightness) override;
+
+  const CRGB *getFrame() const { return _frame.data(); }
+  uint16_t getCount() const { return _frame.size(); }
+  uint8_t getBrightness() const { return _brightness; }
+  uint32_t getFrameCount() const { return _frameCount; }
+};
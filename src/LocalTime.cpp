@@ -0,0 +1,176 @@
+/*
+ * Local time derived from millis() and the last time sync.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include "LocalTime.h"
+
+#define SECONDS_PER_DAY 86400UL
+#define TRANSITION_SEARCH_DAYS 400 // DST rules change the offset at least once a year, if at all
+
+LocalTime::LocalTime(TUtcOffsetFunction onGetOffset)
+    : _onGetOffset(onGetOffset),
+      _synced(false),
+      _baseUtc(0),
+      _baseUs(0),
+      _baseMillis(0),
+      _lastSync(0),
+      _drift(0),
+      _driftRemainder(0),
+      _lastError(0),
+      _syncInterval(SYNC_MIN_INTERVAL_MS),
+      _offset(0),
+      _offsetFrom(1),
+      _offsetUntil(0)
+{
+}
+
+void LocalTime::sync(uint32_t utc, uint16_t ms, unsigned long atMillis)
+{
+  if (_synced)
+    discipline(getError(utc, ms, atMillis), atMillis - _lastSync);
+
+  // Everything is done in one go, so no lookup sees a half updated base
+  _baseUtc = utc;
+  _baseUs = ms * 1000UL;
+  _baseMillis = atMillis;
+  _lastSync = atMillis;
+  _synced = true;
+}
+
+// Local time in µs since 1970 at atMillis, which may also lie before the base
+int64_t LocalTime::getUs(unsigned long atMillis) const
+{
+  long elapsed = (long)(atMillis - _baseMillis);
+  return (int64_t)_baseUtc * 1000000 + _baseUs + (int64_t)elapsed * 1000 +
+         ((int64_t)elapsed * _drift + _driftRemainder) / 1000000;
+}
+
+int64_t LocalTime::getUtcMs(unsigned long atMillis) const
+{
+  return getUs(atMillis) / 1000;
+}
+
+// Sample minus local time at atMillis in ms
+int32_t LocalTime::getError(uint32_t utc, uint16_t ms, unsigned long atMillis) const
+{
+  int64_t error = ((int64_t)utc * 1000000 + ms * 1000LL - getUs(atMillis)) / 1000;
+  return constrain(error, (int64_t)INT32_MIN, (int64_t)INT32_MAX);
+}
+
+// Frequency locked loop: the error over the last interval is the remaining drift.
+// Short intervals mostly measure the network jitter, so they only get a small weight.
+void LocalTime::discipline(int32_t error, unsigned long interval)
+{
+  _lastError = error;
+
+  if (abs(error) > SYNC_STEP_MS)
+  {
+    // The time has jumped, e.g. a different server or a long outage. Start over.
+    _syncInterval = SYNC_MIN_INTERVAL_MS;
+    return;
+  }
+
+  if (interval >= FLL_MIN_INTERVAL_MS)
+  {
+    // Signed math throughout, unsigned long is 64 bit on the host
+    int64_t span = interval;
+    int64_t measured = (int64_t)error * 1000000000LL / span;
+    int64_t drift = _drift + measured * span / (span + (int64_t)FLL_TIME_CONSTANT_MS);
+    _drift = constrain(drift, (int64_t)-MAX_DRIFT_PPB, (int64_t)MAX_DRIFT_PPB);
+  }
+
+  if (abs(error) < SYNC_GOOD_MS)
+    _syncInterval = min(_syncInterval * 2, SYNC_MAX_INTERVAL_MS);
+  else if (abs(error) > SYNC_BAD_MS)
+    _syncInterval = max(_syncInterval / 2, SYNC_MIN_INTERVAL_MS);
+}
+
+// Moves the base forward by the time that has passed, corrected by the drift.
+// Keeps the difference to millis() small, so it survives the wrap around of millis().
+void LocalTime::advance(unsigned long now)
+{
+  unsigned long elapsed = now - _baseMillis;
+  if (elapsed < 1000)
+    return;
+
+  // In units of 10^-6 µs, the part below one µs is carried over so the rounding doesn't add up
+  int64_t correction = (int64_t)elapsed * _drift + _driftRemainder;
+  _driftRemainder = correction % 1000000;
+
+  int64_t us = (int64_t)_baseUs + (int64_t)elapsed * 1000 + correction / 1000000;
+  _baseUtc += us / 1000000;
+  _baseUs = us % 1000000;
+  _baseMillis = now;
+}
+
+uint32_t LocalTime::getUtc(uint16_t &ms)
+{
+  unsigned long now = millis();
+  advance(now);
+
+  uint32_t total = _baseUs / 1000 + (now - _baseMillis);
+  ms = total % 1000;
+  return _baseUtc + total / 1000;
+}
+
+uint32_t LocalTime::getUtc()
+{
+  uint16_t ms;
+  return getUtc(ms);
+}
+
+bool LocalTime::getLocalTime(int &hours, int &minutes, int &seconds, int &milliseconds)
+{
+  if (!_synced)
+    return false;
+
+  uint16_t ms;
+  uint32_t utc = getUtc(ms);
+  if ((utc < _offsetFrom) || (utc >= _offsetUntil))
+    updateOffset(utc);
+
+  uint32_t daySeconds = (utc + _offset) % SECONDS_PER_DAY;
+  hours = daySeconds / 3600;
+  minutes = (daySeconds / 60) % 60;
+  seconds = daySeconds % 60;
+  milliseconds = ms;
+  return true;
+}
+
+// Evaluates the time zone rules once and caches the result up to the next transition
+void LocalTime::updateOffset(uint32_t utc)
+{
+  _offset = _onGetOffset(utc);
+  _offsetFrom = utc;
+  _offsetUntil = findTransition(utc, _offset);
+}
+
+// Returns the first UTC second after utc with a different offset.
+// Steps forward a day at a time and then bisects the day of the change down to the second.
+uint32_t LocalTime::findTransition(uint32_t utc, int32_t offset)
+{
+  uint32_t low = utc;
+  for (uint16_t day = 0; day < TRANSITION_SEARCH_DAYS; day++)
+  {
+    uint32_t high = low + SECONDS_PER_DAY;
+    if (_onGetOffset(high) != offset)
+    {
+      // The offset of low is still the old one, the offset of high is the new one
+      while (high - low > 1)
+      {
+        uint32_t mid = low + (high - low) / 2;
+        if (_onGetOffset(mid) == offset)
+          low = mid;
+        else
+          high = mid;
+      }
+      return high;
+    }
+    low = high;
+  }
+  // No transition in sight, look again later
+  return low;
+}
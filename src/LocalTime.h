@@ -0,0 +1,86 @@
+/*
+ * Local time derived from millis() and the last time sync.
+ *
+ * A sync stores the UTC time together with the millis() at which it was taken.
+ * The UTC offset is cached together with the instant of the next DST transition,
+ * so the time zone rules are only evaluated after a transition or a sync that jumps
+ * out of the cached range. Looking up the local time is integer math on millis().
+ * The clock keeps running on the last sync when the network is gone.
+ *
+ * The crystal of the ESP8266 is off by tens of ppm. Every sync compares the sample
+ * with the local time, steps the local time to the sample and feeds the error into
+ * a frequency locked loop, which corrects millis() for the drift. The sync interval
+ * is doubled while the error stays small and halved when it grows.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include <time.h>
+
+#define SYNC_MIN_INTERVAL_MS 64000UL    // Sync interval until the drift is known
+#define SYNC_MAX_INTERVAL_MS 8192000UL  // Longest sync interval (2h 16m)
+#define SYNC_GOOD_MS 25                 // Errors below this double the sync interval ...
+#define SYNC_BAD_MS 50                  // ... errors above this halve it
+#define SYNC_STEP_MS 1000               // Errors above this are a jump of the time, not drift
+#define FLL_MIN_INTERVAL_MS 60000UL     // Shorter intervals are dominated by the network jitter
+#define FLL_TIME_CONSTANT_MS 1024000UL  // Weight of an error is interval / (interval + time constant)
+#define MAX_DRIFT_PPB 500000L           // Corrections beyond 500 ppm are considered broken
+
+// Returns the UTC offset in seconds which is in effect at the given UTC time
+typedef std::function<int32_t(uint32_t utc)> TUtcOffsetFunction;
+
+class LocalTime
+{
+private:
+  TUtcOffsetFunction _onGetOffset;
+
+  bool _synced;
+  uint32_t _baseUtc;         // UTC seconds ...
+  uint32_t _baseUs;          // ... and µs at _baseMillis
+  unsigned long _baseMillis;
+  unsigned long _lastSync;   // millis() of the last sync
+
+  int32_t _drift;            // Correction of millis() in ppb, positive when millis() is slow
+  int32_t _driftRemainder;   // Part of the correction below one µs, carried over to the next advance
+  int32_t _lastError;        // Sample minus local time at the last sync in ms
+  unsigned long _syncInterval;
+
+  int32_t _offset;          // Cached UTC offset in seconds
+  uint32_t _offsetFrom;     // The cached offset is valid from this UTC second ...
+  uint32_t _offsetUntil;    // ... up to the next transition, excluding
+
+  void advance(unsigned long now);
+  int64_t getUs(unsigned long atMillis) const;
+  int32_t getError(uint32_t utc, uint16_t ms, unsigned long atMillis) const;
+  void discipline(int32_t error, unsigned long interval);
+  void updateOffset(uint32_t utc);
+  uint32_t findTransition(uint32_t utc, int32_t offset);
+
+public:
+  explicit LocalTime(TUtcOffsetFunction onGetOffset);
+
+  // Sets the clock to the given UTC time, which was valid at millis() == atMillis
+  void sync(uint32_t utc, uint16_t ms, unsigned long atMillis);
+
+  bool isSynced() const { return _synced; }
+
+  // ms since the last sync, tells how far the clock may have drifted
+  unsigned long getSyncAge() const { return millis() - _lastSync; }
+
+  // Sync interval which keeps the error below SYNC_BAD_MS
+  unsigned long getSyncInterval() const { return _syncInterval; }
+  int32_t getDrift() const { return _drift; }
+  int32_t getLastError() const { return _lastError; }
+
+  // UTC in ms since 1970 at the given millis(), also for a millis() in the past.
+  // Counts from 0 at millis() == 0 until the first sync.
+  int64_t getUtcMs(unsigned long atMillis) const;
+  uint32_t getUtc();
+  uint32_t getUtc(uint16_t &ms);
+  // The milliseconds carry the fraction of the NTP time, so the seconds change at the true second boundary
+  bool getLocalTime(int &hours, int &minutes, int &seconds, int &milliseconds);
+};
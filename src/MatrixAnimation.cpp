@@ -10,58 +10,102 @@
 #include "MatrixAnimation.h"
 
 MatrixAnimation::MatrixAnimation(const ILedMatrix *ledMatrix, CRGB *_leds, uint16_t count)
-    : LedEffect(_leds, count), _ledMatrix(ledMatrix)
+    : LedEffect(_leds, count),
+      _ledMatrix(ledMatrix)
 {
+  uint8_t width = _ledMatrix->getWidth();
+  _heads = new int32_t[width];
+  _speeds = new uint16_t[width];
+  _lengths = new uint8_t[width];
+  _brightness = new uint8_t[width];
+  _rows = new int16_t[width];
+  spawnAll();
+  setFrameRate(MATRIX_FRAME_RATE);
 }
 
-bool MatrixAnimation::paint(bool force)
+MatrixAnimation::~MatrixAnimation()
 {
-  bool result = false;
+  delete[] _heads;
+  delete[] _speeds;
+  delete[] _lengths;
+  delete[] _brightness;
+  delete[] _rows;
+}
 
-  // falling speed
-  EVERY_N_MILLIS(100)
-  {
-    // move code downward
-    // start with lowest row to allow proper overlapping on each column
-    // for (int8_t row = _ledMatrix->getHeight() - 1; row >= 0; row--)
-    for (int8_t row = 0; row < _ledMatrix->getHeight(); row++)
-    {
-      for (int8_t col = 0; col < _ledMatrix->getWidth(); col++)
-      {
-        if (_leds[_ledMatrix->toStrip(col, row)] == _startColor)
-        {
-          _leds[_ledMatrix->toStrip(col, row)] = CRGB(27, 130, 39); // create trail
-          if (row > 0)
-            _leds[_ledMatrix->toStrip(col, row - 1)] = _startColor;
-        }
-      }
-    }
+void MatrixAnimation::init()
+{
+  LedEffect::init();
+  spawnAll();
+}
+
+// Starts a new drop in col with its head at row
+void MatrixAnimation::spawn(uint8_t col, int16_t row)
+{
+  _heads[col] = (int32_t)row << 16;
+  _speeds[col] = ((uint32_t)random8(MATRIX_MIN_SPEED, MATRIX_MAX_SPEED + 1) << 16) / 1000;
+  _lengths[col] = random8(MATRIX_MIN_LENGTH, MATRIX_MAX_LENGTH + 1);
+  _brightness[col] = random8(MATRIX_MIN_BRIGHTNESS, 255);
+  _rows[col] = row;
+}
+
+// Scatters the drops over the matrix and the gap above, so they don't all start at once
+void MatrixAnimation::spawnAll()
+{
+  for (uint8_t col = 0; col < _ledMatrix->getWidth(); col++)
+    spawn(col, random8(_ledMatrix->getHeight() + MATRIX_MAX_GAP));
+}
+
+// Clears the pixels of the drop in col as it was last drawn, returns true if any of them was visible
+bool MatrixAnimation::erase(uint8_t col)
+{
+  int16_t bottom = max(_rows[col], (int16_t)0);
+  int16_t top = min((int16_t)(_rows[col] + _lengths[col]), (int16_t)_ledMatrix->getHeight());
+  for (int16_t y = bottom; y < top; y++)
+    _leds[_ledMatrix->xy(col, y)] = CRGB::Black;
+  return bottom < top;
+}
+
+// Draws the drop in col with the head at the bottom and the trail fading out above it,
+// returns true if any of its pixels is visible
+bool MatrixAnimation::draw(uint8_t col)
+{
+  int16_t row = _rows[col];
+  int16_t height = _ledMatrix->getHeight();
+  uint8_t scale = _brightness[col];
+  bool visible = false;
 
-    // fade all _leds
-    for (int i = 0; i < _ledMatrix->getCount(); i++)
+  for (uint8_t i = 0; (i < _lengths[col]) && (row + i < height); i++)
+  {
+    if (row + i >= 0)
     {
-      if (_leds[i].g != 255)
-        _leds[i].nscale8(192); // only fade trail
+      CRGB color = (i == 0) ? _startColor : _trailColor;
+      _leds[_ledMatrix->xy(col, row + i)] = color.nscale8(scale);
+      visible = true;
     }
+    scale = scale8(scale, MATRIX_TRAIL_FADE);
+  }
+  return visible;
+}
 
-    // check for empty screen to ensure code spawn
-    // bool emptyScreen = true;
-    // for (int i = 0; i < _ledMatrix->getCount(); i++)
-    // {
-    //     if (_leds[i])
-    //     {
-    //         emptyScreen = false;
-    //         break;
-    //     }
-    // }
+bool MatrixAnimation::paint(unsigned long elapsed, bool force)
+{
+  bool result = false;
+  for (uint8_t col = 0; col < _ledMatrix->getWidth(); col++)
+  {
+    _heads[col] -= (int32_t)(elapsed * _speeds[col]);
+    int16_t row = _heads[col] >> 16;
+    if (!force && (row == _rows[col]))
+      continue;
 
-    // spawn new falling code
-    // if (random8(8) == 0 || emptyScreen) // lower number == more frequent spawns
-    // {
-    int8_t spawnX = random8(_ledMatrix->getWidth());
-    _leds[_ledMatrix->toStrip(spawnX, _ledMatrix->getHeight()-1)] = _startColor;
-    // }
-    result = true;
+    // Erasing counts as a change, so the frame in which a drop leaves the screen clears its last pixels
+    result |= erase(col);
+    if (row + _lengths[col] <= 0)
+      // The trail has left the bottom, start over above the top
+      spawn(col, _ledMatrix->getHeight() + random8(MATRIX_MAX_GAP));
+    else
+      _rows[col] = row;
+    result |= draw(col);
   }
-  return result;
+  // A forced frame repaints a cleared layer, even if no drop is on screen yet
+  return result || force;
 }
@@ -1,6 +1,12 @@
 /*
  * Matrix style animation using the LedMatrix base class.
- * 
+ *
+ * Every column has one drop which falls from above the top of the matrix to below
+ * its bottom and then starts over with a new speed, length and brightness.
+ * The drops are kept in fixed point, struct of arrays, and are drawn from that
+ * state only. A column is only redrawn when the row of its drop has changed.
+ * A frame is a change if a visible pixel was erased or drawn, or if it was forced.
+ *
  * Version: 1.0
  * Author: Lübbe Onken (http://github.com/luebbe)
  */
@@ -10,6 +16,15 @@
 #include "LedEffect.h"
 #include "LedMatrix.h"
 
+#define MATRIX_FRAME_RATE 40         // Frames per second
+#define MATRIX_MIN_SPEED 6           // Rows per second of the slowest ...
+#define MATRIX_MAX_SPEED 14          // ... and of the fastest drop
+#define MATRIX_MIN_LENGTH 4          // Rows of a drop including its head
+#define MATRIX_MAX_LENGTH 10
+#define MATRIX_MAX_GAP 12            // A new drop starts up to this many rows above the top
+#define MATRIX_MIN_BRIGHTNESS 128
+#define MATRIX_TRAIL_FADE 192        // Each row of the trail has 192/256 of the brightness of the row below
+
 class MatrixAnimation : public LedEffect
 {
 private:
@@ -18,9 +33,22 @@ private:
   const CRGB _startColor = CRGB(175, 255, 175);
   const CRGB _trailColor = CRGB(27, 130, 39);
 
+  // One drop per column
+  int32_t *_heads;      // Q16.16 row of the head, counts down towards the bottom
+  uint16_t *_speeds;    // Q16.16 rows per ms
+  uint8_t *_lengths;    // Rows including the head
+  uint8_t *_brightness;
+  int16_t *_rows;       // Row of the head as it was last drawn
+
+  void spawn(uint8_t col, int16_t row);
+  void spawnAll();
+  bool erase(uint8_t col);
+  bool draw(uint8_t col);
+
 public:
   explicit MatrixAnimation(const ILedMatrix *ledMatrix, CRGB *leds, uint16_t count);
+  ~MatrixAnimation();
 
-  void init(){};
-  bool paint(bool force) override;
-};
\ No newline at end of file
+  void init() override;
+  bool paint(unsigned long elapsed, bool force) override;
+};
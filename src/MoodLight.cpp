@@ -8,15 +8,31 @@
 #include "MoodLight.h"
 
 MoodLight::MoodLight(const ILedMatrix *ledMatrix, CRGB *_leds, uint16_t count)
-    : LedEffect(_leds, count), _ledMatrix(ledMatrix)
+    : LedEffect(_leds, count), _ledMatrix(ledMatrix), _color(MOOD_DEFAULT_COLOR), _changed(true)
 {
 }
 
-bool MoodLight::paint(bool force)
+bool MoodLight::paint(unsigned long elapsed, bool force)
 {
-  for (int i = 0; i < _numLeds; i++)
+  if (!force && !_changed)
+    return false;
+
+  fill_solid(_leds, _numLeds, _color);
+  _changed = false;
+  return true;
+}
+
+unsigned long MoodLight::getNextUpdate()
+{
+  // Nothing to animate, only a new color is due right away
+  return _changed ? millis() : millis() + IDLE_MS;
+}
+
+void MoodLight::setColor(CRGB color)
+{
+  if (color != _color)
   {
-    _leds[i] = CRGB::Black;
+    _color = color;
+    _changed = true;
   }
-  return true;
-}
\ No newline at end of file
+}
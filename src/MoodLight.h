@@ -1,5 +1,8 @@
 /*
  * Mood light (single color) using the LedMatrix base class.
+ *
+ * All LEDs show the same color. The light doesn't change by itself,
+ * so it is only painted when it is forced to or when the color has changed.
  * 
  * Version: 1.0
  * Author: Lübbe Onken (http://github.com/luebbe)
@@ -10,14 +13,22 @@
 #include "LedEffect.h"
 #include "LedMatrix.h"
 
+#define MOOD_DEFAULT_COLOR CRGB(255, 147, 41) // Warm white, like a candle
+
 class MoodLight : public LedEffect
 {
 private:
   const ILedMatrix *_ledMatrix;
+  CRGB _color;
+  bool _changed; // The color has changed since the last paint
 
 public:
   explicit MoodLight(const ILedMatrix *ledMatrix, CRGB *leds, uint16_t count);
 
   void init(){};
-  bool paint(bool force) override;
-};
\ No newline at end of file
+  bool paint(unsigned long elapsed, bool force) override;
+  unsigned long getNextUpdate() override;
+
+  void setColor(CRGB color);
+  CRGB getColor() const { return _color; }
+};
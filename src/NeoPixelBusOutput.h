@@ -0,0 +1,77 @@
+/*
+ * Asynchronous LED output using the DMA and UART methods of NeoPixelBus.
+ *
+ * submit() applies brightness, color correction and the power limit while copying the frame
+ * into the pixel buffer of NeoPixelBus, which is the second buffer next to the DMA/UART buffer
+ * that is currently being transmitted. The transmission runs in the background without disabling interrupts.
+ *
+ * The methods are bound to fixed pins:
+ *   NeoEsp8266DmaWs2812xMethod         - I2S DMA on GPIO3 (RX, D9 on the D1 Mini)
+ *   NeoEsp8266AsyncUart1Ws2812xMethod  - UART1 on GPIO2 (D4 on the D1 Mini)
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include <NeoPixelBus.h>
+#include "LedOutput.h"
+
+template <typename T_METHOD>
+class NeoPixelBusOutput : public ILedOutput
+{
+private:
+  NeoPixelBus<NeoGrbFeature, T_METHOD> _strip;
+  const CRGB _correction;
+  const uint32_t _maxPowerV;
+  const uint32_t _maxPowerMa;
+  bool _pending; // A frame is waiting in the pixel buffer
+
+public:
+  explicit NeoPixelBusOutput(uint16_t count, CRGB correction, uint32_t maxPowerV, uint32_t maxPowerMa)
+      : _strip(count), _correction(correction), _maxPowerV(maxPowerV), _maxPowerMa(maxPowerMa), _pending(false)
+  {
+  }
+
+  void begin() override
+  {
+    _strip.Begin();
+  }
+
+  void submit(const CRGB *leds, uint16_t count, uint8_t brightness) override
+  {
+    // Same scaling as FastLED.show(): power limit, then brightness and color correction per channel
+    brightness = calculate_max_brightness_for_power_vmA(leds, count, brightness, _maxPowerV, _maxPowerMa);
+    uint8_t scaleR = scale8(_correction.r, brightness);
+    uint8_t scaleG = scale8(_correction.g, brightness);
+    uint8_t scaleB = scale8(_correction.b, brightness);
+
+    uint8_t *pixels = _strip.Pixels();
+    uint16_t n = (count < _strip.PixelCount()) ? count : _strip.PixelCount();
+    for (uint16_t i = 0; i < n; i++)
+    {
+      *pixels++ = scale8(leds[i].g, scaleG);
+      *pixels++ = scale8(leds[i].r, scaleR);
+      *pixels++ = scale8(leds[i].b, scaleB);
+    }
+    _strip.Dirty();
+    _pending = true;
+
+    update();
+  }
+
+  void update() override
+  {
+    if (_pending && _strip.CanShow())
+    {
+      _strip.Show();
+      _pending = false;
+    }
+  }
+
+  bool isBusy() const override
+  {
+    return _pending || !_strip.CanShow();
+  }
+};
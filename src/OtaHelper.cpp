@@ -1,21 +1,22 @@
 #include "OtaHelper.h"
 
-OtaHelper::OtaHelper(const ILedMatrix *ledMatrix, CRGB * leds, uint16_t count)
-    : LedEffect(leds, count), _ledMatrix(ledMatrix)
+OtaHelper::OtaHelper(const ILedMatrix *ledMatrix, ILedOutput *output, CRGB * leds, uint16_t count)
+    : LedEffect(leds, count), _ledMatrix(ledMatrix), _output(output)
 {
 }
 
 void OtaHelper::onStart()
 {
-  FastLED.clear(true);
+  memset8((void *)_leds, 0, sizeof(struct CRGB) * _numLeds);
+  _output->submit(_leds, _numLeds, FastLED.getBrightness());
 }
 
 void OtaHelper::onEnd()
 {
   uint8_t y = uint8_t(_ledMatrix->getHeight() / 2);
   for (uint8_t x = 0; x < _ledMatrix->getWidth(); x++)
-    _leds[_ledMatrix->toStrip(x, y)] = CRGB::LimeGreen;
-  FastLED.show();
+    _leds[_ledMatrix->xy(x, y)] = CRGB::LimeGreen;
+  _output->submit(_leds, _numLeds, FastLED.getBrightness());
 }
 
 void OtaHelper::onError(ota_error_t error)
@@ -56,9 +57,9 @@ void OtaHelper::onProgress(unsigned int progress, unsigned int total)
   // 100% would lead to overflow, just draw the bar until 99%
   if (x < _ledMatrix->getWidth())
   {
-    _leds[_ledMatrix->toStrip(x, y)] = CHSV(220, 100, brightness);
+    _leds[_ledMatrix->xy(x, y)] = CHSV(220, 100, brightness);
   }
-  FastLED.show();
+  _output->submit(_leds, _numLeds, FastLED.getBrightness());
 }
 
 void OtaHelper::init()
@@ -82,7 +83,7 @@ void OtaHelper::init()
   ArduinoOTA.begin();
 }
 
-bool OtaHelper::paint(bool force)
+bool OtaHelper::paint(unsigned long elapsed, bool force)
 {
   return false;
 }
\ No newline at end of file
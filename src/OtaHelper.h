@@ -3,11 +3,13 @@
 #include <ArduinoOTA.h>
 #include "LedEffect.h"
 #include "LedMatrix.h"
+#include "LedOutput.h"
 
 class OtaHelper : public LedEffect
 {
 private:
   const ILedMatrix *_ledMatrix;
+  ILedOutput *_output; // The main loop doesn't run during the update, so the progress is sent directly
 
   void onStart();
   void onEnd();
@@ -15,8 +17,8 @@ private:
   void onProgress(unsigned int progress, unsigned int total);
 
 public:
-  explicit OtaHelper(const ILedMatrix *ledMatrix, CRGB *leds, uint16_t count);
+  explicit OtaHelper(const ILedMatrix *ledMatrix, ILedOutput *output, CRGB *leds, uint16_t count);
 
   void init() override;
-  bool paint(bool force) override;
+  bool paint(unsigned long elapsed, bool force) override;
 };
@@ -0,0 +1,122 @@
+/*
+ * Scoped cycle counter profiling for the phases of the main loop.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include "Profiler.h"
+
+const char C_ZONE_LOOP[] PROGMEM = "loop";
+const char C_ZONE_EFFECT[] PROGMEM = "effect";
+const char C_ZONE_OVERLAY[] PROGMEM = "overlay";
+const char C_ZONE_SHOW[] PROGMEM = "show";
+const char C_ZONE_LIGHT[] PROGMEM = "light";
+const char C_ZONE_MQTT[] PROGMEM = "mqtt";
+const char C_ZONE_OTA[] PROGMEM = "ota";
+const char C_ZONE_TIME[] PROGMEM = "time";
+
+const char *const ZONENAMES[] PROGMEM = {
+    C_ZONE_LOOP,
+    C_ZONE_EFFECT,
+    C_ZONE_OVERLAY,
+    C_ZONE_SHOW,
+    C_ZONE_LIGHT,
+    C_ZONE_MQTT,
+    C_ZONE_OTA,
+    C_ZONE_TIME};
+
+const char *getZoneName(uint8_t zone)
+{
+  return (const char *)pgm_read_ptr(&ZONENAMES[zone]);
+}
+
+#ifdef PROFILING
+
+Profiler profiler;
+
+Profiler::Profiler()
+{
+  reset();
+}
+
+void Profiler::reset()
+{
+  memset(_zones, 0, sizeof(_zones));
+  for (uint8_t i = 0; i < ZONE_COUNT; i++)
+  {
+    _zones[i].minCycles = UINT32_MAX;
+  }
+}
+
+// The bucket is the position of the highest set bit plus the next PROFILE_SUB_BUCKET_BITS bits below it.
+uint8_t Profiler::toBucket(uint32_t cycles)
+{
+  if (cycles < (1 << PROFILE_SUB_BUCKET_BITS))
+    return cycles;
+
+  uint8_t msb = 31 - __builtin_clz(cycles);
+  uint8_t sub = (cycles >> (msb - PROFILE_SUB_BUCKET_BITS)) & ((1 << PROFILE_SUB_BUCKET_BITS) - 1);
+  return ((msb - PROFILE_SUB_BUCKET_BITS + 1) << PROFILE_SUB_BUCKET_BITS) + sub;
+}
+
+// Upper bound of the cycles that fall into a bucket
+uint32_t Profiler::fromBucket(uint8_t bucket)
+{
+  if (bucket < (1 << PROFILE_SUB_BUCKET_BITS))
+    return bucket;
+
+  uint8_t msb = (bucket >> PROFILE_SUB_BUCKET_BITS) + PROFILE_SUB_BUCKET_BITS - 1;
+  uint32_t sub = bucket & ((1 << PROFILE_SUB_BUCKET_BITS) - 1);
+  uint64_t lower = (1ULL << msb) + (sub << (msb - PROFILE_SUB_BUCKET_BITS));
+  uint64_t upper = lower + (1ULL << (msb - PROFILE_SUB_BUCKET_BITS)) - 1;
+  return (upper > UINT32_MAX) ? UINT32_MAX : upper;
+}
+
+void Profiler::add(uint8_t zone, uint32_t cycles)
+{
+  TZone &z = _zones[zone];
+
+  z.count++;
+  z.sumCycles += cycles;
+  if (cycles < z.minCycles)
+    z.minCycles = cycles;
+  if (cycles > z.maxCycles)
+    z.maxCycles = cycles;
+
+  uint16_t &bucket = z.histogram[toBucket(cycles)];
+  if (bucket < UINT16_MAX)
+    bucket++;
+}
+
+bool Profiler::getStats(uint8_t zone, TProfileStats &stats) const
+{
+  const TZone &z = _zones[zone];
+  if (z.count == 0)
+    return false;
+
+  uint32_t cyclesPerUs = ESP.getCpuFreqMHz();
+
+  stats.count = z.count;
+  stats.minUs = z.minCycles / cyclesPerUs;
+  stats.avgUs = (z.sumCycles / z.count) / cyclesPerUs;
+  stats.maxUs = z.maxCycles / cyclesPerUs;
+
+  // Walk the histogram from the top until more than 1% of the samples are covered
+  uint32_t limit = z.count / 100;
+  uint32_t above = 0;
+  stats.p99Us = stats.maxUs;
+  for (int i = PROFILE_BUCKETS - 1; i >= 0; i--)
+  {
+    above += z.histogram[i];
+    if (above > limit)
+    {
+      uint32_t p99 = fromBucket(i);
+      stats.p99Us = ((p99 < z.maxCycles) ? p99 : z.maxCycles) / cyclesPerUs;
+      break;
+    }
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * Scoped cycle counter profiling for the phases of the main loop.
+ *
+ * Each zone collects min/avg/max and a fixed size histogram of its run times,
+ * from which the 99th percentile is estimated. Everything compiles to nothing
+ * unless PROFILING is defined.
+ *
+ * Usage:
+ *   {
+ *     PROFILE_ZONE(ZONE_SHOW);
+ *     FastLED.show();
+ *   }
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+enum TPROFILEZONE
+{
+  ZONE_LOOP,    // One full iteration of loop()
+  ZONE_EFFECT,  // Paint of the active effect
+  ZONE_OVERLAY, // Paint of the status overlay
+  ZONE_SHOW,    // FastLED.show()
+  ZONE_LIGHT,   // Light sensor and brightness
+  ZONE_MQTT,    // mqttClient.loop() and the periodic publishes
+  ZONE_OTA,     // ArduinoOTA.handle()
+  ZONE_TIME,    // Time sync
+  ZONE_COUNT
+};
+
+// Name of the zone in flash, used for the MQTT topics
+const char *getZoneName(uint8_t zone);
+
+#ifdef PROFILING
+
+// The histogram has four buckets per power of two of cycles,
+// so the percentile estimate is at most 19% above the true value.
+#define PROFILE_SUB_BUCKET_BITS 2
+#define PROFILE_BUCKETS (32 << PROFILE_SUB_BUCKET_BITS)
+
+struct TProfileStats
+{
+  uint32_t count;
+  uint32_t minUs;
+  uint32_t avgUs;
+  uint32_t maxUs;
+  uint32_t p99Us;
+};
+
+class Profiler
+{
+private:
+  struct TZone
+  {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t sumCycles;
+    uint16_t histogram[PROFILE_BUCKETS];
+  };
+
+  TZone _zones[ZONE_COUNT];
+
+  static uint8_t toBucket(uint32_t cycles);
+  static uint32_t fromBucket(uint8_t bucket);
+
+public:
+  Profiler();
+
+  void add(uint8_t zone, uint32_t cycles);
+  bool getStats(uint8_t zone, TProfileStats &stats) const;
+  void reset();
+};
+
+extern Profiler profiler;
+
+class ProfileScope
+{
+private:
+  uint8_t _zone;
+  uint32_t _start;
+
+public:
+  explicit ProfileScope(uint8_t zone) : _zone(zone), _start(ESP.getCycleCount()) {}
+  ~ProfileScope() { profiler.add(_zone, ESP.getCycleCount() - _start); }
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_ZONE(zone) ProfileScope PROFILE_CONCAT(_profileScope, __LINE__)(zone)
+
+#else
+
+#define PROFILE_ZONE(zone)
+
+#endif
@@ -13,9 +13,10 @@
 RainbowAnimation::RainbowAnimation(const ILedMatrix *ledMatrix, CRGB * leds, uint16_t count)
     : LedEffect(leds, count), _ledMatrix(ledMatrix)
 {
+  setFrameRate(RAINBOW_FRAME_RATE);
 }
 
-bool RainbowAnimation::paint(bool force)
+bool RainbowAnimation::paint(unsigned long elapsed, bool force)
 {
   uint32_t ms = millis();
   int32_t yHueDelta32 = ((int32_t)cos16(ms * (27 / 1)) * (350 / _ledMatrix->getWidth()));
@@ -26,6 +27,7 @@ bool RainbowAnimation::paint(bool force)
 
 void RainbowAnimation::DrawOneFrame(byte startHue8, int8_t yHueDelta8, int8_t xHueDelta8)
 {
+  const CRGB *hues = colorCache.getHues();
   byte lineStartHue = startHue8;
   for (byte y = 0; y < _ledMatrix->getHeight(); y++)
   {
@@ -34,7 +36,7 @@ void RainbowAnimation::DrawOneFrame(byte startHue8, int8_t yHueDelta8, int8_t xH
     for (byte x = 0; x < _ledMatrix->getWidth(); x++)
     {
       pixelHue += xHueDelta8;
-      _leds[_ledMatrix->toStrip(x, y)] = CHSV(pixelHue, 255, 255);
+      _leds[_ledMatrix->xy(x, y)] = hues[pixelHue];
     }
   }
 }
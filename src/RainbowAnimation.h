@@ -13,6 +13,8 @@
 #include "LedEffect.h"
 #include "LedMatrix.h"
 
+#define RAINBOW_FRAME_RATE FRAME_RATE // The colors follow millis(), the frame rate only sets how smooth they change
+
 class RainbowAnimation : public LedEffect
 {
 private:
@@ -24,5 +26,5 @@ public:
   explicit RainbowAnimation(const ILedMatrix *ledMatrix, CRGB *leds, uint16_t count);
 
   void init(){};
-  bool paint(bool force) override;
+  bool paint(unsigned long elapsed, bool force) override;
 };
\ No newline at end of file
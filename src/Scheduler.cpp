@@ -0,0 +1,159 @@
+/*
+ * Cooperative deadline scheduler for the main loop.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include "Scheduler.h"
+
+Scheduler::Scheduler()
+    : _taskCount(0), _queued(0)
+{
+}
+
+TTaskId Scheduler::add(const char *name, TTASKPRIORITY priority, unsigned long interval, TTaskFunction function)
+{
+  if (_taskCount >= SCHEDULER_MAX_TASKS)
+    return -1;
+
+  TTaskId id = _taskCount++;
+  TTask &task = _tasks[id];
+  task.name = name;
+  task.function = function;
+  task.priority = priority;
+  task.interval = interval;
+  task.active = false;
+  task.runs = 0;
+  task.overruns = 0;
+  task.maxLate = 0;
+
+  if (interval > 0)
+    scheduleAt(id, millis());
+  return id;
+}
+
+// Inserts the task behind all tasks which are due at the same time or earlier
+void Scheduler::enqueue(uint8_t id)
+{
+  uint8_t i = _queued;
+  while ((i > 0) && !isDue(_tasks[_queue[i - 1]].due, _tasks[id].due))
+  {
+    _queue[i] = _queue[i - 1];
+    i--;
+  }
+  _queue[i] = id;
+  _queued++;
+  _tasks[id].active = true;
+}
+
+void Scheduler::dequeue(uint8_t id)
+{
+  for (uint8_t i = 0; i < _queued; i++)
+  {
+    if (_queue[i] == id)
+    {
+      memmove(&_queue[i], &_queue[i + 1], _queued - i - 1);
+      _queued--;
+      break;
+    }
+  }
+  _tasks[id].active = false;
+}
+
+void Scheduler::scheduleAt(TTaskId id, unsigned long at)
+{
+  if ((id < 0) || (id >= _taskCount))
+    return;
+
+  if (_tasks[id].active)
+    dequeue(id);
+  _tasks[id].due = at;
+  enqueue(id);
+}
+
+void Scheduler::cancel(TTaskId id)
+{
+  if (isScheduled(id))
+    dequeue(id);
+}
+
+void Scheduler::setInterval(TTaskId id, unsigned long interval)
+{
+  if ((id < 0) || (id >= _taskCount) || (_tasks[id].interval == interval))
+    return;
+
+  // A shorter interval takes effect right away, not only after the end of the old one
+  _tasks[id].interval = interval;
+  if (_tasks[id].active && (interval > 0) && isDue(millis() + interval, _tasks[id].due))
+    scheduleAt(id, millis() + interval);
+}
+
+unsigned long Scheduler::getNextDeadline() const
+{
+  if (_queued == 0)
+    return millis() + SCHEDULER_IDLE_MS;
+  return _tasks[_queue[0]].due;
+}
+
+uint8_t Scheduler::run()
+{
+  unsigned long now = millis();
+
+  // The due tasks are at the front of the queue, in the order of their deadlines.
+  // Sort them by priority, the stable insertion sort keeps the deadline order within a priority.
+  uint8_t due[SCHEDULER_MAX_TASKS];
+  uint8_t count = 0;
+  for (uint8_t i = 0; (i < _queued) && isDue(_tasks[_queue[i]].due, now); i++)
+  {
+    uint8_t id = _queue[i];
+    uint8_t j = count++;
+    while ((j > 0) && (_tasks[due[j - 1]].priority > _tasks[id].priority))
+    {
+      due[j] = due[j - 1];
+      j--;
+    }
+    due[j] = id;
+  }
+
+  uint8_t ran = 0;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    TTask &task = _tasks[due[i]];
+    // An earlier task may have canceled or rescheduled this one
+    if (!task.active || !isDue(task.due, now))
+      continue;
+
+    unsigned long start = millis();
+    unsigned long late = start - task.due;
+    task.runs++;
+    task.maxLate = max(task.maxLate, late);
+    if (late >= ((task.interval > 0) ? task.interval : SCHEDULER_LATE_MS))
+      task.overruns++;
+
+    // Schedule the next run before this one, so the task can change it
+    dequeue(due[i]);
+    if (task.interval > 0)
+    {
+      task.due += task.interval;
+      if (isDue(task.due, start))
+        // Skip the missed runs
+        task.due = start + task.interval;
+      enqueue(due[i]);
+    }
+
+    task.function();
+    ran++;
+  }
+  return ran;
+}
+
+void Scheduler::resetStats()
+{
+  for (uint8_t i = 0; i < _taskCount; i++)
+  {
+    _tasks[i].runs = 0;
+    _tasks[i].overruns = 0;
+    _tasks[i].maxLate = 0;
+  }
+}
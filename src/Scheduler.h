@@ -0,0 +1,93 @@
+/*
+ * Cooperative deadline scheduler for the main loop.
+ *
+ * Every piece of work of the main loop is a task with a deadline. The active tasks
+ * are kept in a queue ordered by deadline, so the earliest deadline is always at its
+ * front and the loop can sleep until then. run() executes the tasks which are due,
+ * the ones with the higher priority first and within a priority the earliest deadline
+ * first. Tasks are never interrupted, each one runs to its end.
+ *
+ * Periodic tasks are scheduled again one interval after their last deadline. When a
+ * whole interval has been missed they are counted as an overrun and the missed
+ * runs are skipped. One-shot tasks run once per schedule() and may schedule
+ * themselves again, e.g. to follow a deadline which they compute themselves.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+#define SCHEDULER_MAX_TASKS 12
+#define SCHEDULER_LATE_MS 10    // One-shot tasks which start later than this count as an overrun
+#define SCHEDULER_IDLE_MS 1000  // Deadline horizon when no task is scheduled
+
+// Compares two millis() timestamps, robust against the wrap around after 49 days
+inline bool isDue(unsigned long deadline, unsigned long now)
+{
+  return (long)(now - deadline) >= 0;
+}
+
+typedef std::function<void()> TTaskFunction;
+typedef int8_t TTaskId;
+
+enum TTASKPRIORITY
+{
+  TASK_FRAME,   // Painting and sending the LED frame
+  TASK_SENSOR,  // Light sensor, feeds the brightness of the next frame
+  TASK_NETWORK, // MQTT, OTA, NTP and the reconnects
+  TASK_REPORT   // Periodic publishes
+};
+
+struct TTask
+{
+  const char *name;
+  TTaskFunction function;
+  TTASKPRIORITY priority;
+  unsigned long interval; // 0 for one-shot tasks
+  unsigned long due;
+  bool active;            // The task is in the queue
+
+  // Since the last resetStats()
+  uint32_t runs;
+  uint32_t overruns;      // Periodic: started a whole interval late, one-shot: more than SCHEDULER_LATE_MS late
+  unsigned long maxLate;  // ms between deadline and start
+};
+
+class Scheduler
+{
+private:
+  TTask _tasks[SCHEDULER_MAX_TASKS];
+  uint8_t _taskCount;
+  uint8_t _queue[SCHEDULER_MAX_TASKS]; // Active tasks ordered by deadline
+  uint8_t _queued;
+
+  void enqueue(uint8_t id);
+  void dequeue(uint8_t id);
+
+public:
+  Scheduler();
+
+  // Returns the id of the task, -1 if there is no room for it.
+  // Periodic tasks (interval > 0) are due right away, one-shot tasks wait for schedule().
+  TTaskId add(const char *name, TTASKPRIORITY priority, unsigned long interval, TTaskFunction function);
+
+  // (Re)schedules a task, periodic tasks continue with their interval from there
+  void schedule(TTaskId id, unsigned long delay) { scheduleAt(id, millis() + delay); }
+  void scheduleAt(TTaskId id, unsigned long at);
+  void cancel(TTaskId id);
+  void setInterval(TTaskId id, unsigned long interval);
+  bool isScheduled(TTaskId id) const { return (id >= 0) && _tasks[id].active; }
+
+  // millis() at which the next task is due, it may lie in the past
+  unsigned long getNextDeadline() const;
+
+  // Runs the tasks which are due, returns how many ran
+  uint8_t run();
+
+  uint8_t getTaskCount() const { return _taskCount; }
+  const TTask &getTask(uint8_t index) const { return _tasks[index]; }
+  void resetStats();
+};
@@ -11,25 +11,23 @@ SnakeAnimation::SnakeAnimation(const ILedMatrix *ledMatrix, CRGB *leds, uint16_t
     : LedEffect(leds, count),
       _ledMatrix(ledMatrix), _hue(192)
 {
+  setFrameRate(SNAKE_FRAME_RATE);
 }
 
-bool SnakeAnimation::paint(bool force)
+bool SnakeAnimation::paint(unsigned long elapsed, bool force)
 {
-  // Update the "Fraction Bar" by 1/16th pixel every time
-  _pos16 += _delta16;
+  // Move the "Fraction Bar" by SNAKE_SPEED 1/16000 pixel per ms
+  _pos += SNAKE_SPEED * elapsed;
 
   // wrap around at end
-  // remember that _pos16 contains position in "16ths of a pixel"
-  // so the 'end of the strip' is (NUM_LEDS * 16)
-  if (_pos16 >= (_ledMatrix->getCount() * 16))
-  {
-    _pos16 -= (_ledMatrix->getCount() * 16);
-  }
+  // remember that _pos contains position in "16ths of a pixel" * 1000
+  // so the 'end of the strip' is (NUM_LEDS * 16 * 1000)
+  _pos %= _ledMatrix->getCount() * 16UL * 1000UL;
 
   memset8(_leds, 0, _ledMatrix->getCount() * sizeof(CRGB));
 
   // draw the Fractional Bar, length=4px, hue=180
-  drawFractionalBar(_pos16, 4, _hue);
+  drawFractionalBar(_pos / 1000, 4, _hue);
 
   return true;
 }
@@ -87,7 +85,7 @@ void SnakeAnimation::drawFractionalBar(int pos16, int width, uint8_t hue)
       bright = 255;
     }
 
-    _leds[i] += CHSV(hue, 255, bright);
+    _leds[i] += colorCache.getHue(hue, bright);
     i++;
     if (i == _ledMatrix->getCount())
       i = 0; // wrap around
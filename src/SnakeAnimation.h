@@ -10,15 +10,15 @@
 #include "LedEffect.h"
 #include "LedMatrix.h"
 
+#define SNAKE_FRAME_RATE FRAME_RATE
+#define SNAKE_SPEED 100 // 1/16000 pixel per ms, the same as 16ths of a pixel per second (100 = 6.25 pixels per second)
+
 class SnakeAnimation : public LedEffect
 {
 private:
-#define FACTOR 100
-
   const ILedMatrix *_ledMatrix;
   uint8_t _hue;
-  int _pos16 = 0;   // position of the "fraction-based bar"
-  int _delta16 = 1; // how many 16ths of a pixel to move the Fractional Bar
+  uint32_t _pos = 0; // position of the "fraction-based bar" in 1/16000 pixel (16ths of a pixel * 1000), advanced by SNAKE_SPEED per ms
 
   void drawFractionalBar(int pos16, int width, uint8_t hue);
 
@@ -26,6 +26,6 @@ public:
   explicit SnakeAnimation(const ILedMatrix *ledMatrix, CRGB *leds, uint16_t count);
 
   void init(){};
-  bool paint(bool force) override;
+  bool paint(unsigned long elapsed, bool force) override;
   void setHue(uint8_t hue) { _hue = hue; };
 };
\ No newline at end of file
@@ -0,0 +1,317 @@
+/*
+ * Non-blocking SNTP client with server selection.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include "SntpClient.h"
+
+#ifdef ARDUINO_ARCH_ESP8266
+#include <lwip/dns.h>
+#endif
+
+#define NTP_UNIX_OFFSET 2208988800UL // Seconds from 1900 (NTP era) to 1970 (Unix epoch)
+#define SNTP_MAX_BACKOFF_SHIFT 5     // The back off grows up to SNTP_RETRY_MS * 32
+
+// Offsets of the fields in the SNTP packet
+#define SNTP_ORIGIN 24
+#define SNTP_RECEIVE 32
+#define SNTP_TRANSMIT 40
+
+static uint32_t readUint32(const uint8_t *buffer)
+{
+  return ((uint32_t)buffer[0] << 24) | ((uint32_t)buffer[1] << 16) | ((uint32_t)buffer[2] << 8) | buffer[3];
+}
+
+static void writeUint32(uint8_t *buffer, uint32_t value)
+{
+  buffer[0] = value >> 24;
+  buffer[1] = value >> 16;
+  buffer[2] = value >> 8;
+  buffer[3] = value;
+}
+
+// Converts the 32 bit binary fraction of a NTP timestamp to ms
+static uint16_t fractionToMs(uint32_t fraction)
+{
+  return ((uint64_t)fraction * 1000) >> 32;
+}
+
+SntpClient::SntpClient(UDP &udp, const char *const servers[], uint8_t count,
+                       TSntpClockFunction clock, TSntpSyncFunction onSync)
+    : _udp(udp),
+      _serverCount(min(count, (uint8_t)SNTP_MAX_SERVERS)),
+      _clock(clock),
+      _onSync(onSync),
+      _state(SNTP_IDLE),
+      _current(0),
+      _answered(false),
+      _selected(-1),
+      _lastSync(0),
+      _stateStart(0),
+      _nextRequest(0),
+      _interval(SNTP_INTERVAL_MS),
+      _failures(0),
+      _cookie(0)
+{
+  for (uint8_t i = 0; i < _serverCount; i++)
+  {
+    _servers[i].name = servers[i];
+    _servers[i].resolved = false;
+    _servers[i].failures = 0;
+  }
+}
+
+void SntpClient::begin()
+{
+  _udp.stop();
+  _udp.begin(SNTP_LOCAL_PORT);
+  _state = SNTP_IDLE;
+  _nextRequest = millis();
+}
+
+void SntpClient::update()
+{
+  unsigned long now = millis();
+
+  switch (_state)
+  {
+  case SNTP_IDLE:
+    // Throw away late replies to earlier requests, parsePacket() skips the previous packet
+    while (_udp.parsePacket() > 0)
+      ;
+    if (((long)(now - _nextRequest) >= 0) && (_serverCount > 0))
+    {
+      _current = 0;
+      _answered = false;
+      startRequest(now);
+    }
+    break;
+
+  case SNTP_RESOLVING:
+    if (_servers[_current].resolved)
+      sendRequest(now);
+    else if (now - _stateStart >= SNTP_TIMEOUT_MS)
+      fail(now);
+    break;
+
+  case SNTP_WAITING:
+    if (receiveReply(now))
+    {
+      _servers[_current].failures = 0;
+      _answered = true;
+      nextServer(now);
+    }
+    else if (now - _stateStart >= SNTP_TIMEOUT_MS)
+      fail(now);
+    break;
+  }
+}
+
+void SntpClient::startRequest(unsigned long now)
+{
+  TSntpServer &server = _servers[_current];
+  _stateStart = now;
+
+  if (server.resolved)
+  {
+    sendRequest(now);
+    return;
+  }
+
+  _state = SNTP_RESOLVING;
+#ifdef ARDUINO_ARCH_ESP8266
+  // Returns the address right away if it is cached, otherwise onDnsFound is called later
+  ip_addr_t address;
+  err_t err = dns_gethostbyname(server.name, &address, onDnsFound, this);
+  if (err == ERR_OK)
+  {
+    server.ip = IPAddress(&address);
+    server.resolved = true;
+    sendRequest(now);
+  }
+  else if (err != ERR_INPROGRESS)
+    fail(now);
+#else
+  if (server.ip.fromString(server.name))
+  {
+    server.resolved = true;
+    sendRequest(now);
+  }
+  else
+    fail(now);
+#endif
+}
+
+#ifdef ARDUINO_ARCH_ESP8266
+// Called by lwIP outside of loop(), only hands over the address
+void SntpClient::onDnsFound(const char *name, const ip_addr_t *ip, void *arg)
+{
+  SntpClient *client = (SntpClient *)arg;
+  TSntpServer &server = client->_servers[client->_current];
+  if (ip && (client->_state == SNTP_RESOLVING) && (strcmp(name, server.name) == 0))
+  {
+    server.ip = IPAddress(ip);
+    server.resolved = true;
+  }
+}
+#endif
+
+void SntpClient::sendRequest(unsigned long now)
+{
+  uint8_t packet[SNTP_PACKET_SIZE];
+
+  memset(packet, 0, SNTP_PACKET_SIZE);
+  packet[0] = 0x23; // No leap second warning, version 4, client mode
+
+  // A random transmit timestamp, which the server copies into the origin timestamp of its reply.
+  // It ties the reply to this request, late replies to earlier requests and spoofed packets don't match.
+  _cookie = (uint32_t)random(1, 0x7FFFFFFF) ^ micros();
+  writeUint32(&packet[SNTP_TRANSMIT], _cookie);
+
+  if (!_udp.beginPacket(_servers[_current].ip, SNTP_PORT) ||
+      (_udp.write(packet, SNTP_PACKET_SIZE) != SNTP_PACKET_SIZE) ||
+      !_udp.endPacket())
+  {
+    fail(now);
+    return;
+  }
+
+  _state = SNTP_WAITING;
+  _stateStart = millis();
+}
+
+bool SntpClient::receiveReply(unsigned long now)
+{
+  uint8_t packet[SNTP_PACKET_SIZE];
+  TSntpServer &server = _servers[_current];
+
+  if (_udp.parsePacket() < SNTP_PACKET_SIZE)
+    return false;
+  if ((_udp.remoteIP() != server.ip) || (_udp.read(packet, SNTP_PACKET_SIZE) != SNTP_PACKET_SIZE))
+    return false;
+
+  uint8_t leap = packet[0] >> 6;
+  uint8_t mode = packet[0] & 0x07;
+  uint8_t stratum = packet[1];
+
+  // Unsynchronized server, not a server reply or a "kiss of death"
+  if ((leap == 3) || (mode != 4) || (stratum == 0) || (stratum > 15))
+    return false;
+  if ((readUint32(&packet[SNTP_ORIGIN]) != _cookie) || (readUint32(&packet[SNTP_ORIGIN + 4]) != 0))
+    return false;
+
+  uint32_t receiveSeconds = readUint32(&packet[SNTP_RECEIVE]);
+  uint32_t transmitSeconds = readUint32(&packet[SNTP_TRANSMIT]);
+  if (transmitSeconds == 0)
+    return false;
+
+  // The round trip time minus the time the request spent on the server
+  int32_t processing = (int32_t)(transmitSeconds - receiveSeconds) * 1000 +
+                       fractionToMs(readUint32(&packet[SNTP_TRANSMIT + 4])) -
+                       fractionToMs(readUint32(&packet[SNTP_RECEIVE + 4]));
+  int32_t rtt = (int32_t)(now - _stateStart) - max(processing, (int32_t)0);
+  if (rtt < 0)
+    rtt = 0;
+
+  // The reply took half of the round trip time to get here
+  uint32_t ms = fractionToMs(readUint32(&packet[SNTP_TRANSMIT + 4])) + rtt / 2;
+
+  TSntpSample sample;
+  sample.utc = transmitSeconds - NTP_UNIX_OFFSET + ms / 1000;
+  sample.ms = ms % 1000;
+  sample.atMillis = now;
+  sample.rttMs = min(rtt, (int32_t)0xFFFF);
+
+  // An outlier still counts as answer, it only doesn't make it into the filter
+  server.filter.add(sample, _clock);
+  return true;
+}
+
+void SntpClient::nextServer(unsigned long now)
+{
+  _state = SNTP_IDLE;
+  if (++_current < _serverCount)
+    startRequest(now);
+  else
+    finishPoll(now);
+}
+
+void SntpClient::fail(unsigned long now)
+{
+  TSntpServer &server = _servers[_current];
+  if (server.failures < 0xFF)
+    server.failures++;
+
+  // Resolve the name again, the pool may have handed out a server which has gone
+  server.resolved = false;
+  nextServer(now);
+}
+
+void SntpClient::finishPoll(unsigned long now)
+{
+  if (_answered)
+  {
+    _failures = 0;
+    select(now);
+    _nextRequest = now + _interval;
+    return;
+  }
+
+  if (_failures < 0xFF)
+    _failures++;
+
+  unsigned long backoff = SNTP_RETRY_MS << min(_failures - 1, SNTP_MAX_BACKOFF_SHIFT);
+  _nextRequest = now + min(backoff, _interval);
+}
+
+// Picks the server of the largest group which agrees on the time, and of those the one with the shortest round trip
+void SntpClient::select(unsigned long now)
+{
+  const TSntpSample *best[SNTP_MAX_SERVERS];
+  int64_t offset[SNTP_MAX_SERVERS];
+
+  for (uint8_t i = 0; i < _serverCount; i++)
+  {
+    best[i] = _servers[i].filter.getBest(now);
+    if (best[i])
+      offset[i] = ClockFilter::getOffset(*best[i], _clock);
+  }
+
+  int8_t selected = -1;
+  uint8_t selectedVotes = 0;
+  uint32_t selectedDistance = UINT32_MAX;
+
+  for (uint8_t i = 0; i < _serverCount; i++)
+  {
+    if (!best[i])
+      continue;
+
+    uint8_t votes = 0;
+    for (uint8_t j = 0; j < _serverCount; j++)
+      if (best[j] && (abs(offset[i] - offset[j]) <= CLOCK_FILTER_SPIKE_MS))
+        votes++;
+
+    uint32_t distance = ClockFilter::getDistance(*best[i], now);
+    if ((votes > selectedVotes) || ((votes == selectedVotes) && (distance < selectedDistance)))
+    {
+      selected = i;
+      selectedVotes = votes;
+      selectedDistance = distance;
+    }
+  }
+
+  if (selected < 0)
+    return;
+
+  // The best sample may be one that was already used
+  const TSntpSample &sample = *best[selected];
+  if ((_selected >= 0) && ((long)(sample.atMillis - _lastSync) <= 0))
+    return;
+
+  _selected = selected;
+  _lastSync = sample.atMillis;
+  if (_onSync)
+    _onSync(sample);
+}
@@ -0,0 +1,110 @@
+/*
+ * Non-blocking SNTP client with server selection.
+ *
+ * update() is called on every loop and never waits: it sends a request, returns,
+ * and picks up the reply on a later loop. The server names are resolved asynchronously.
+ * Requests that are not answered within SNTP_TIMEOUT_MS are given up.
+ *
+ * Every poll asks all configured servers in turn and adds their replies to a clock
+ * filter per server. The servers then vote: the largest group of servers whose
+ * offsets agree within CLOCK_FILTER_SPIKE_MS survives, a server that is far off the
+ * others is ignored. Of the survivors the one with the shortest round trip is
+ * selected, its best sample is passed to the sync callback if it is newer than the
+ * last one. With a single server only its own clock filter rejects outliers.
+ *
+ * Polls without any reply are retried with a growing back off.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include <IPAddress.h>
+#include <Udp.h>
+
+#ifdef ARDUINO_ARCH_ESP8266
+#include <lwip/ip_addr.h>
+#endif
+
+#include "ClockFilter.h"
+
+#define SNTP_PORT 123
+#define SNTP_LOCAL_PORT 1337      // Same port as the NTPClient used before
+#define SNTP_TIMEOUT_MS 1000UL    // Time to wait for a reply
+#define SNTP_RETRY_MS 2000UL      // First back off after a failed poll, doubled on every further failure
+#define SNTP_INTERVAL_MS 60000UL  // Time between two successful polls
+#define SNTP_PACKET_SIZE 48
+#define SNTP_MAX_SERVERS 4
+
+typedef std::function<void(const TSntpSample &sample)> TSntpSyncFunction;
+
+enum TSNTPSTATE
+{
+  SNTP_IDLE,      // Waiting for the next poll
+  SNTP_RESOLVING, // Waiting for the IP address of the current server
+  SNTP_WAITING    // Waiting for the reply of the current server
+};
+
+struct TSntpServer
+{
+  const char *name;
+  IPAddress ip;
+  volatile bool resolved; // Set by the DNS callback
+  uint8_t failures;       // Unanswered requests in a row
+  ClockFilter filter;
+};
+
+class SntpClient
+{
+private:
+  UDP &_udp;
+  TSntpServer _servers[SNTP_MAX_SERVERS];
+  uint8_t _serverCount;
+  TSntpClockFunction _clock;
+  TSntpSyncFunction _onSync;
+
+  TSNTPSTATE _state;
+  uint8_t _current;          // Server which is asked in the current poll
+  bool _answered;            // At least one server has answered in the current poll
+  int8_t _selected;          // Server of the last sync, -1 if there was none yet
+  unsigned long _lastSync;   // millis() of the last sample passed to the sync callback
+  unsigned long _stateStart; // millis() at which the current state was entered
+  unsigned long _nextRequest;
+  unsigned long _interval;
+  uint8_t _failures;         // Polls without any reply in a row
+  uint32_t _cookie;          // Sent as transmit timestamp, the server returns it as origin timestamp
+
+  void startRequest(unsigned long now);
+  void sendRequest(unsigned long now);
+  bool receiveReply(unsigned long now);
+  void nextServer(unsigned long now);
+  void fail(unsigned long now);
+  void finishPoll(unsigned long now);
+  void select(unsigned long now);
+
+#ifdef ARDUINO_ARCH_ESP8266
+  static void onDnsFound(const char *name, const ip_addr_t *ip, void *arg);
+#endif
+
+public:
+  // servers are names or IP addresses, at most SNTP_MAX_SERVERS are used.
+  // clock returns the local time against which the offsets of the servers are compared.
+  explicit SntpClient(UDP &udp, const char *const servers[], uint8_t count,
+                      TSntpClockFunction clock, TSntpSyncFunction onSync);
+
+  // Opens the socket and polls the servers right away. Call this after the network is up.
+  void begin();
+  // Advances the state machine, call this on every loop while the network is up
+  void update();
+
+  void setInterval(unsigned long ms) { _interval = ms; }
+  TSNTPSTATE getState() const { return _state; }
+  uint8_t getFailures() const { return _failures; }
+
+  uint8_t getServerCount() const { return _serverCount; }
+  const TSntpServer &getServer(uint8_t index) const { return _servers[index]; }
+  // Name of the server of the last sync, nullptr if there was none yet
+  const char *getSelectedServer() const { return (_selected < 0) ? nullptr : _servers[_selected].name; }
+};
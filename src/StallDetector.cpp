@@ -0,0 +1,88 @@
+/*
+ * Detects loop() iterations which exceed a time budget and leaves a post-mortem record in RTC user memory.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include "StallDetector.h"
+#include <user_interface.h>
+
+#ifndef STALL_BUDGET_MS
+#define STALL_BUDGET_MS 250 // Five frames
+#endif
+
+StallDetector stallDetector(STALL_BUDGET_MS);
+
+const char C_STALL_BUDGET[] PROGMEM = "budget";
+const char C_STALL_EXCEPTION[] PROGMEM = "exception";
+const char C_STALL_SOFT_WDT[] PROGMEM = "softwdt";
+
+const char *const STALLREASONS[] PROGMEM = {
+    C_STALL_BUDGET,
+    C_STALL_EXCEPTION,
+    C_STALL_SOFT_WDT};
+
+StallDetector::StallDetector(uint32_t budgetMs)
+    : _budgetMs(budgetMs),
+      _loopStart(0),
+      _phaseStart(0),
+      _worstCycles(0),
+      _phase(ZONE_LOOP),
+      _worstPhase(ZONE_LOOP)
+{
+}
+
+void StallDetector::record(uint8_t reason, uint8_t phase, uint32_t cycles)
+{
+  TStallRecord record;
+
+  if (!readRecord(record))
+  {
+    record.magic = STALL_RTC_MAGIC;
+    record.count = 0;
+  }
+
+  record.count++;
+  record.reason = reason;
+  record.phase = phase;
+  record.reserved = 0;
+  record.durationUs = cycles / ESP.getCpuFreqMHz();
+  record.uptimeS = millis() / 1000UL;
+
+  ESP.rtcUserMemoryWrite(STALL_RTC_OFFSET, (uint32_t *)&record, sizeof(record));
+}
+
+void StallDetector::recordCrash(uint8_t reason)
+{
+  record(reason, _phase, ESP.getCycleCount() - _phaseStart);
+}
+
+bool StallDetector::readRecord(TStallRecord &record) const
+{
+  if (!ESP.rtcUserMemoryRead(STALL_RTC_OFFSET, (uint32_t *)&record, sizeof(record)))
+    return false;
+  // RTC memory contains garbage after power on
+  return (record.magic == STALL_RTC_MAGIC) && (record.reason <= STALL_SOFT_WDT) && (record.phase < ZONE_COUNT);
+}
+
+void StallDetector::clearRecord()
+{
+  TStallRecord record;
+  memset(&record, 0, sizeof(record));
+  ESP.rtcUserMemoryWrite(STALL_RTC_OFFSET, (uint32_t *)&record, sizeof(record));
+}
+
+const char *StallDetector::getReasonName(uint8_t reason)
+{
+  return (const char *)pgm_read_ptr(&STALLREASONS[reason]);
+}
+
+// Called by the ESP8266 core before it resets after an exception or a soft watchdog timeout
+extern "C" void custom_crash_callback(struct rst_info *rst_info, uint32_t stack, uint32_t stack_end)
+{
+  if (rst_info->reason == REASON_SOFT_WDT_RST)
+    stallDetector.recordCrash(STALL_SOFT_WDT);
+  else
+    stallDetector.recordCrash(STALL_EXCEPTION);
+}
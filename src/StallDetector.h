@@ -0,0 +1,97 @@
+/*
+ * Detects loop() iterations which exceed a time budget and leaves a post-mortem record in RTC user memory.
+ *
+ * The main loop marks the phase it is about to run. Marking a phase only reads the cycle counter
+ * and keeps the longest phase of the current iteration. If the iteration exceeds the budget,
+ * the longest phase and its duration are written to RTC user memory. If the loop never returns
+ * (exception or soft watchdog), the crash callback records the phase that was executing.
+ * RTC user memory survives these resets, so the record can be published after the next boot.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "Profiler.h"
+
+// Offset in 4 byte blocks. The first 128 bytes of RTC user memory are left to the OTA updater.
+#define STALL_RTC_OFFSET 32
+#define STALL_RTC_MAGIC 0x57434C53 // "WCLS"
+
+enum TSTALLREASON
+{
+  STALL_BUDGET,    // The loop iteration took longer than the budget
+  STALL_EXCEPTION, // The loop was terminated by an exception
+  STALL_SOFT_WDT   // The loop was terminated by the software watchdog
+};
+
+struct TStallRecord
+{
+  uint32_t magic;
+  uint32_t count;      // Number of stalls since the record was last cleared
+  uint8_t reason;      // TSTALLREASON of the last stall
+  uint8_t phase;       // TPROFILEZONE that was executing
+  uint16_t reserved;
+  uint32_t durationUs; // Duration of the phase
+  uint32_t uptimeS;    // Uptime when the stall happened
+};
+
+class StallDetector
+{
+private:
+  uint32_t _budgetMs;
+  uint32_t _loopStart;
+  uint32_t _phaseStart;
+  uint32_t _worstCycles;
+  uint8_t _phase;
+  uint8_t _worstPhase;
+
+  void record(uint8_t reason, uint8_t phase, uint32_t cycles);
+
+public:
+  explicit StallDetector(uint32_t budgetMs);
+
+  inline void beginLoop()
+  {
+    _loopStart = _phaseStart = ESP.getCycleCount();
+    _worstCycles = 0;
+    _phase = _worstPhase = ZONE_LOOP;
+  }
+
+  inline void enter(uint8_t phase)
+  {
+    uint32_t now = ESP.getCycleCount();
+    if (now - _phaseStart > _worstCycles)
+    {
+      _worstCycles = now - _phaseStart;
+      _worstPhase = _phase;
+    }
+    _phase = phase;
+    _phaseStart = now;
+  }
+
+  inline void endLoop()
+  {
+    enter(ZONE_LOOP);
+    // The CPU clock changes in dormant mode, so the budget is converted at the current clock
+    if (_phaseStart - _loopStart > _budgetMs * 1000UL * ESP.getCpuFreqMHz())
+      record(STALL_BUDGET, _worstPhase, _worstCycles);
+  }
+
+  // Called from the crash callback, records the phase that was executing
+  void recordCrash(uint8_t reason);
+
+  bool readRecord(TStallRecord &record) const;
+  void clearRecord();
+
+  static const char *getReasonName(uint8_t reason);
+};
+
+extern StallDetector stallDetector;
+
+// Marks the start of a loop phase for the stall detector and measures it with the profiler
+#define LOOP_PHASE(zone)     \
+  stallDetector.enter(zone); \
+  PROFILE_ZONE(zone)
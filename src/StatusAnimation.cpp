@@ -11,36 +11,47 @@ StatusAnimation::StatusAnimation(const ILedMatrix *ledMatrix, CRGB *leds, uint16
     : LedEffect(leds, count),
       _ledMatrix(ledMatrix),
       _status(SETUP),
-      _lastUpdate(0)
+      _visible(false)
 {
   _minuteLEDs = (_leds + _ledMatrix->getCount()); // Pointer to the start of the buffer for the minute LEDs
+  setFrameRate(1000 / UPDATE_MS);
 }
 
-bool StatusAnimation::paint(bool force)
+bool StatusAnimation::paint(unsigned long elapsed, bool force)
 {
-  uint64_t now = millis();
-  if ((now - _lastUpdate >= UPDATE_MS) || (_lastUpdate == 0))
-  {
-    _lastUpdate = now;
-    uint8_t index = uint8_t(round(now / 250)) % 4;
+  uint8_t index = uint8_t(round(millis() / 250)) % 4;
 
-    switch (_status)
+  switch (_status)
+  {
+  case CLOCK_STATUS::SETUP:
+  case CLOCK_STATUS::WIFI_DISCONNECTED:
+    memset8(_minuteLEDs, 0, sizeof(struct CRGB) * MINUTE_LEDS);
+    _minuteLEDs[index] = colorCache.getHues()[160];
+    _visible = true;
+    return true;
+  case CLOCK_STATUS::WIFI_CONNECTED:
+  case CLOCK_STATUS::MQTT_DISCONNECTED:
+    memset8(_minuteLEDs, 0, sizeof(struct CRGB) * MINUTE_LEDS);
+    _minuteLEDs[index] = colorCache.getHues()[192];
+    _visible = true;
+    return true;
+  case CLOCK_STATUS::MQTT_CONNECTED:
+  default:
+    // Erase the overlay once, so that the layers below become visible again
+    if (_visible)
     {
-    case CLOCK_STATUS::SETUP:
-    case CLOCK_STATUS::WIFI_DISCONNECTED:
-      memset8(_minuteLEDs, 0, sizeof(struct CRGB) * MINUTE_LEDS);
-      _minuteLEDs[index] = CHSV(160, 255, 255);
-      return true;
-    case CLOCK_STATUS::WIFI_CONNECTED:
-    case CLOCK_STATUS::MQTT_DISCONNECTED:
       memset8(_minuteLEDs, 0, sizeof(struct CRGB) * MINUTE_LEDS);
-      _minuteLEDs[index] = CHSV(192, 255, 255);
+      _visible = false;
       return true;
-    case CLOCK_STATUS::MQTT_CONNECTED:
-      return false;
-    default:
-      return false;
     }
+    return false;
   }
-  return false;
+}
+
+unsigned long StatusAnimation::getNextUpdate()
+{
+  // Once connected and erased there is nothing left to animate
+  if ((_status == CLOCK_STATUS::MQTT_CONNECTED) && !_visible)
+    return millis() + IDLE_MS;
+  return LedEffect::getNextUpdate();
 }
@@ -27,12 +27,13 @@ private:
     const ILedMatrix *_ledMatrix;
     CRGB *_minuteLEDs; // Pointer to the start of the buffer for the minute LEDs
     CLOCK_STATUS _status = CLOCK_STATUS::SETUP;
-    unsigned long _lastUpdate;
+    bool _visible; // The overlay has drawn something which has to be erased when it is no longer needed
 
 public:
     explicit StatusAnimation(const ILedMatrix *ledMatrix, CRGB *leds, uint16_t count);
 
     void init(){};
-    bool paint(bool force) override;
+    bool paint(unsigned long elapsed, bool force) override;
+    unsigned long getNextUpdate() override;
     void setStatus(CLOCK_STATUS status) { _status = status; };
 };
@@ -2,34 +2,57 @@
 
 #include <ESP8266WiFi.h>
 #include <WiFiUdp.h>
-#include <NTPClient.h>
 #include <Timezone.h>
 #include <TimeLib.h>
 #include <time.h>
 
-const char *TC_SERVER = "europe.pool.ntp.org";
+#include "LocalTime.h"
+#include "SntpClient.h"
 
-WiFiUDP ntpUDP;
-NTPClient timeClient(ntpUDP, TC_SERVER);
+// The servers are asked in turn, the one with the shortest round trip among those that agree sets the time.
+// Add a server in the LAN with -D NTP_LAN_SERVER=\"192.168.0.1\" in build_flags (a name or an address).
+const char *const NTP_SERVERS[] = {
+#ifdef NTP_LAN_SERVER
+    NTP_LAN_SERVER,
+#endif
+    "0.europe.pool.ntp.org",
+    "1.europe.pool.ntp.org",
+    "2.europe.pool.ntp.org"};
 
 // For starters use hardwired Central European Time (Berlin, Paris, ...)
 TimeChangeRule CEST = {"CEST", Last, Sun, Mar, 2, 120}; // Central European Summer Time
 TimeChangeRule CET = {"CET ", Last, Sun, Oct, 3, 60};   // Central European Standard Time
 Timezone Europe(CEST, CET);
 
-bool onGetTime(int &hours, int &minutes, int &seconds)
+int32_t onGetUtcOffset(uint32_t utc)
 {
-  if (!WiFi.isConnected())
-    return false;
+  TimeChangeRule *tcr;
+  Europe.toLocal(utc, &tcr);
+  return tcr->offset * 60L;
+}
 
-  timeClient.update();
-  time_t localTime = Europe.toLocal(timeClient.getEpochTime());
+LocalTime localTime(onGetUtcOffset);
 
-  hours = ((localTime % 86400L) / 3600) % 24;
-  minutes = (localTime % 3600) / 60;
-  seconds = localTime % 60;
+WiFiUDP ntpUDP;
+SntpClient sntpClient(
+    ntpUDP, NTP_SERVERS, sizeof(NTP_SERVERS) / sizeof(NTP_SERVERS[0]),
+    [](unsigned long atMillis) { return localTime.getUtcMs(atMillis); },
+    [](const TSntpSample &sample) {
+      localTime.sync(sample.utc, sample.ms, sample.atMillis);
+      // The better the drift is known, the less often the servers are asked
+      sntpClient.setInterval(localTime.getSyncInterval());
+    });
 
-  return true;
+// Advances the SNTP state machine, never waits for the network
+void syncTime()
+{
+  sntpClient.update();
+}
+
+// Also works without WiFi, the local time keeps running on the last sync
+bool onGetTime(int &hours, int &minutes, int &seconds, int &milliseconds)
+{
+  return localTime.getLocalTime(hours, minutes, seconds, milliseconds);
 }
 
 class Uptime
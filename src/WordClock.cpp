@@ -7,226 +7,243 @@
 
 #include "WordClock.h"
 
-WordClock::WordClock(const ILedMatrix *ledMatrix, CRGB *leds, uint16_t count, TGetTimeFunction onGetTime)
+// ---------- Layout ----------
+
+// The layout tables are generated from layouts/*.layout by tools/layoutgen.py and live in flash.
+// The words only change every five minutes, so the time -> words table is indexed by
+// [threeQuarters][5 minute slot][hour % 12].
+#include "layouts/WordLayout.h"
+
+static_assert(LAYOUT_WORD_COUNT <= MAX_WORDS, "The layout doesn't fit into the word mask");
+
+constexpr uint32_t wordBit(uint8_t word)
+{
+  return (uint32_t)1 << word;
+}
+
+// ---------- WordClock ----------
+
+WordClock::WordClock(const ILedMatrix *ledMatrix, CRGB *leds, CRGB *accentLeds, uint16_t count, TGetTimeFunction onGetTime)
     : LedEffect(leds, count),
       _ledMatrix(ledMatrix),
       _onGetTime(onGetTime),
       _minuteColor(CRGB(0xFF00FF)), // Initial color for the minute LEDs
-      _secondColor(CRGB(0x00FFFF)), // Initial color for the second LEDs
       _useThreeQuarters(false),
-      _lastUpdate(0)
+      _lastSecond(-1),
+      _lastMinute(-1),
+      _nextPoll(0),
+      _nextFade(0),
+      _forcePending(false),
+      _currentWords(0),
+      _spans(nullptr),
+      _fadeTime(WORD_FADE_MS),
+      _fadeStart(0),
+      _fadingIn(0),
+      _fadingOut(0)
 {
-  _currentWords.clear();
-  _minuteLEDs = (_leds + _ledMatrix->getCount()); // Pointer to the start of the buffer for the minute LEDs
-  _secondLEDs = (_minuteLEDs + MINUTE_LEDS);      // Pointer to the start of the buffer for the second LEDs
+  _minuteLEDs = (accentLeds + _ledMatrix->getCount()); // Pointer to the start of the buffer for the minute LEDs
+  _secondLEDs = (_minuteLEDs + MINUTE_LEDS);           // Pointer to the start of the buffer for the second LEDs
+  if ((_ledMatrix->getWidth() != LAYOUT_WIDTH) || (_ledMatrix->getHeight() != LAYOUT_HEIGHT))
+  {
+    // The word positions would be outside of the strip. Without any spans no word is drawn and the matrix stays blank.
+    DEBUG_PRINTF("Layout %s is %dx%d, but the matrix is %dx%d\r\n", LAYOUT_NAME, LAYOUT_WIDTH, LAYOUT_HEIGHT,
+                 _ledMatrix->getWidth(), _ledMatrix->getHeight());
+    memset(_firstSpan, 0, sizeof(_firstSpan));
+    memset(_overlaps, 0, sizeof(_overlaps));
+  }
+  else
+  {
+    _spans = new TSPAN[createSpans(nullptr)];
+    createSpans(_spans);
+  }
+#ifdef HAS_SECONDS
+  _secondsLit = 0;
+#endif
 }
 
-void WordClock::init()
+WordClock::~WordClock()
 {
-  memset8(_minuteLEDs, 0, sizeof(struct CRGB) * MINUTE_LEDS);
-  memset8(_secondLEDs, 0, sizeof(struct CRGB) * SECOND_LEDS);
+  delete[] _spans;
 }
 
-bool WordClock::paint(bool force)
+// Converts the word positions of the layout into runs of strip indices.
+// On a horizontal matrix each word is a single run, so drawing a word doesn't need any coordinate math.
+// Called with nullptr to count the spans.
+uint8_t WordClock::createSpans(TSPAN *spans)
 {
-  uint64_t now = millis();
-  if (force || (now - _lastUpdate >= UPDATE_MS) || (_lastUpdate == 0))
-  {
-    _lastUpdate = now;
+  uint8_t count = 0;
 
-    int hours;
-    int minutes;
-    int seconds;
+  for (uint8_t word = 0; word < LAYOUT_WORD_COUNT; word++)
+  {
+    TLAYOUTWORD info;
+    memcpy_P(&info, &LAYOUT_WORDS[word], sizeof(info));
+    TSPAN span = {0, 1, 0};
 
-    if (_onGetTime(hours, minutes, seconds))
+    _firstSpan[word] = count;
+    for (uint8_t j = 0; j < info.len; j++)
     {
+      int index = _ledMatrix->xy(info.x + j, info.y);
 
-// When there are no minute LEDs, advance the clock by 2.5 minutes.
-// so that the current time is "centered" around the displayed time.
-// e.g. 16:57:30..17:02:29 are shown as "five o'clock"
-#ifndef HAS_MINUTES
-      int minuteOffset = (seconds < 30 ? 2 : 3);
-      // Check whether the offset pushes us into the next hour
-      if (minutes + minuteOffset >= 60)
+      // The second pixel decides about the direction of the run
+      if ((span.len == 1) && ((index == span.first + 1) || (index == span.first - 1)))
       {
-        hours++;
+        span.step = index - span.first;
+        span.len++;
+        continue;
+      }
+      if ((span.len > 1) && (index == span.first + span.step * span.len))
+      {
+        span.len++;
+        continue;
       }
-      minutes = (minutes + minuteOffset) % 60;
-#endif
 
-      if (minutes == 0)
+      if (span.len > 0)
       {
-        createRandomPalette();
+        if (spans)
+          spans[count] = span;
+        count++;
       }
+      span = {(uint16_t)index, 1, 1};
+    }
 
-      updateHours(hours, minutes, force);
-      updateMinutes(minutes, force);
-      updateSeconds(seconds);
-      return true;
+    if (span.len > 0)
+    {
+      if (spans)
+        spans[count] = span;
+      count++;
     }
   }
-  return false;
+  _firstSpan[LAYOUT_WORD_COUNT] = count;
+
+  // Two words overlap if they share pixels in the same row
+  for (uint8_t i = 0; i < LAYOUT_WORD_COUNT; i++)
+  {
+    TLAYOUTWORD a;
+    memcpy_P(&a, &LAYOUT_WORDS[i], sizeof(a));
+    _overlaps[i] = 0;
+    for (uint8_t j = 0; j < LAYOUT_WORD_COUNT; j++)
+    {
+      TLAYOUTWORD b;
+      memcpy_P(&b, &LAYOUT_WORDS[j], sizeof(b));
+      if ((i != j) && (a.y == b.y) && (a.x < b.x + b.len) && (b.x < a.x + a.len))
+      {
+        _overlaps[i] |= wordBit(j);
+      }
+    }
+  }
+
+  return count;
 }
 
-void WordClock::createWords(TWORDBUF &newWords, int &hour, int &minute)
+void WordClock::init()
 {
-  // The order of the word indexes in the array is not the order of the words on the display.
-  newWords.clear();
-  newWords.push_back(_O_ES_);
-  newWords.push_back(_O_IST_);
+  memset8(_minuteLEDs, 0, sizeof(struct CRGB) * MINUTE_LEDS);
+  memset8(_secondLEDs, 0, sizeof(struct CRGB) * SECOND_LEDS);
+  createSecondGradient();
+#ifdef HAS_SECONDS
+  _secondsLit = 0;
+#endif
+}
 
-  switch (minute)
+bool WordClock::paint(unsigned long elapsed, bool force)
+{
+  unsigned long now = millis();
+  bool result = false;
+
+  // The palette may have changed. Take the gradient right away, even if there is no time to show yet.
+  // Without the time the forced repaint is retried with the next poll, not on every frame.
+  if (force)
   {
-  case 0 ... 4:
-    // This places "o'clock" before the hour in the output array, but it's only visible in the debug output.
-    newWords.push_back(_O_UHR_);
-    break;
-  case 5 ... 9:
-    newWords.push_back(_M_FUENF_);
-    newWords.push_back(_O_NACH_);
-    break;
-  case 10 ... 14:
-    newWords.push_back(_M_ZEHN_);
-    newWords.push_back(_O_NACH_);
-    break;
-  case 15 ... 19:
-    if (_useThreeQuarters)
-    {
-      // Use "quarter hh+1" for hh:15
-      newWords.push_back(_M_VIERTEL_);
-      hour += 1;
-    }
-    else
-    {
-      // Use "quarter past hh" for hh:15
-      newWords.push_back(_M_VIERTEL_);
-      newWords.push_back(_O_NACH_);
-    }
-    break;
-  case 20 ... 24:
-    newWords.push_back(_M_ZWANZIG_);
-    newWords.push_back(_O_NACH_);
-    break;
-  case 25 ... 29:
-    newWords.push_back(_M_FUENF_);
-    newWords.push_back(_O_VOR_);
-    newWords.push_back(_M_HALB_);
-    hour += 1;
-    break;
-  case 30 ... 34:
-    newWords.push_back(_M_HALB_);
-    hour += 1;
-    break;
-  case 35 ... 39:
-    newWords.push_back(_M_FUENF_);
-    newWords.push_back(_O_NACH_);
-    newWords.push_back(_M_HALB_);
-    hour += 1;
-    break;
-  case 40 ... 44:
-    newWords.push_back(_M_ZWANZIG_);
-    newWords.push_back(_O_VOR_);
-    hour += 1;
-    break;
-  case 45 ... 49:
-    if (_useThreeQuarters)
-    {
-      // Use "three quarters hh+1" for hh:45
-      newWords.push_back(_M_DREIVIERTEL_);
-    }
-    else
-    {
-      // Use "quarter to hh+1" for hh:45
-      newWords.push_back(_M_VIERTEL_);
-      newWords.push_back(_O_VOR_);
-    }
-    hour += 1;
-    break;
-  case 50 ... 54:
-    newWords.push_back(_M_ZEHN_);
-    newWords.push_back(_O_VOR_);
-    hour += 1;
-    break;
-  case 55 ... 59:
-    newWords.push_back(_M_FUENF_);
-    newWords.push_back(_O_VOR_);
-    hour += 1;
-    break;
+    createSecondGradient();
+    _forcePending = true;
   }
 
-  // Limit to 12H display
-  if (hour > 12)
-    hour = hour - 12;
+  if (force || isDue(_nextPoll, now))
+  {
+    result = updateTime(now, _forcePending);
+    if (result)
+      _forcePending = false;
+  }
 
-  switch (hour)
+  if (((_fadingIn | _fadingOut) != 0) && isDue(_nextFade, now))
   {
-  case 1:
-    // Subtle difference in German:
-    // "Es ist ein Uhr", aber "es ist fünf nach eins".
-    if (minute >= 0 && minute <= 4)
-    {
-      newWords.push_back(_H_EIN_);
-    }
-    else
-    {
-      newWords.push_back(_H_EINS_);
-    }
-    break;
-  case 2:
-    newWords.push_back(_H_ZWEI_);
-    break;
-  case 3:
-    newWords.push_back(_H_DREI_);
-    break;
-  case 4:
-    newWords.push_back(_H_VIER_);
-    break;
-  case 5:
-    newWords.push_back(_H_FUENF_);
-    break;
-  case 6:
-    newWords.push_back(_H_SECHS_);
-    break;
-  case 7:
-    newWords.push_back(_H_SIEBEN_);
-    break;
-  case 8:
-    newWords.push_back(_H_ACHT_);
-    break;
-  case 9:
-    newWords.push_back(_H_NEUN_);
-    break;
-  case 10:
-    newWords.push_back(_H_ZEHN_);
-    break;
-  case 11:
-    newWords.push_back(_H_ELF_);
-    break;
-  case 12:
-    newWords.push_back(_H_ZWOELF_);
-    break;
-  default:
-    newWords.push_back(_H_ZWOELF_);
-    break;
+    updateFade(false);
+    _nextFade = now + UPDATE_MS;
+    result = true;
   }
+  return result;
 }
 
-void WordClock::updateHours(int &hours, int &minutes, bool force)
+unsigned long WordClock::getNextUpdate()
 {
-  TWORDBUF newWords;
+  if (((_fadingIn | _fadingOut) != 0) && !isDue(_nextPoll, _nextFade))
+    return _nextFade;
+  return _nextPoll;
+}
 
-  if (force)
-    _currentWords.clear();
+// Looks up the time and repaints if the displayed second has changed
+bool WordClock::updateTime(unsigned long now, bool force)
+{
+  int hours;
+  int minutes;
+  int seconds;
+  int milliseconds;
+
+  if (!_onGetTime(hours, minutes, seconds, milliseconds))
+  {
+    // No time available, keep asking
+    _nextPoll = now + UPDATE_MS;
+    return false;
+  }
+
+  // Right at the next second boundary
+  _nextPoll = now + 1000 - constrain(milliseconds, 0, 999);
 
-  createWords(newWords, hours, minutes);
+  if (!force && (seconds == _lastSecond))
+    return false;
+
+  _lastSecond = seconds;
+
+// When there are no minute LEDs, advance the clock by 2.5 minutes.
+// so that the current time is "centered" around the displayed time.
+// e.g. 16:57:30..17:02:29 are shown as "five o'clock"
+#ifndef HAS_MINUTES
+  int minuteOffset = (seconds < 30 ? 2 : 3);
+  // Check whether the offset pushes us into the next hour
+  if (minutes + minuteOffset >= 60)
+  {
+    hours++;
+  }
+  minutes = (minutes + minuteOffset) % 60;
+#endif
+
+  if ((minutes == 0) && (_lastMinute != 0))
+  {
+    createRandomPalette();
+  }
+  _lastMinute = minutes;
+
+  updateHours(hours, minutes, force);
+  updateMinutes(minutes, force);
+  updateSeconds(seconds, force);
+  return true;
+}
+
+WordClock::TWORDMASK WordClock::getWords(int hour, int minute)
+{
+  return pgm_read_dword(&LAYOUT_TIME_WORDS[_useThreeQuarters ? 1 : 0][(minute / 5) % 12][hour % 12]);
+}
+
+void WordClock::updateHours(int &hours, int &minutes, bool force)
+{
+  TWORDMASK newWords = getWords(hours, minutes);
 
   // Update the LED matrix if the values have changed
-  if (_currentWords != newWords)
+  if (force || (_currentWords != newWords))
   {
-    DEBUG_PRINTF("%02d:%02d sending %d words:", hours, minutes, newWords.size());
+    DEBUG_PRINTF("%02d:%02d sending %d words:", hours, minutes, __builtin_popcount(newWords));
 
-    _currentWords = newWords;
-    sendWords();
+    sendWords(newWords, force);
 
     DEBUG_PRINTF("\r\n");
   }
@@ -243,6 +260,7 @@ void WordClock::updateMinutes(int &minutes, bool force)
     memset8(_minuteLEDs, 0, sizeof(struct CRGB) * MINUTE_LEDS);
     _minuteColor = getRandomColor();
   }
+  markDirty(_ledMatrix->getCount(), MINUTE_LEDS);
 
   // Set the color for all minutes up to the current minute
   for (int i = 0; i <= minuteIndex; i++)
@@ -252,59 +270,147 @@ void WordClock::updateMinutes(int &minutes, bool force)
 #endif
 }
 
-void WordClock::updateSeconds(int &seconds)
+void WordClock::createSecondGradient()
+{
+#ifdef HAS_SECONDS
+  for (uint8_t i = 0; i < SECOND_LEDS; i++)
+    _secondGradient[i] = getColorFromPalette(255 * i / SECOND_LEDS);
+#endif
+}
+
+// Only the LEDs which have been reached since the last update are drawn
+void WordClock::updateSeconds(int &seconds, bool force)
 {
 #ifdef HAS_SECONDS
-  static bool resetBuffer = true;
-  int secondIndex = (seconds * SECOND_LEDS / 60);
+  uint8_t lit = seconds * SECOND_LEDS / 60 + 1; // LEDs 0..seconds are lit
 
-  // Erase buffer in second 0 and pick a new color for all LEDs for the next minute
-  if ((secondIndex == 0) && resetBuffer)
+  uint16_t firstSecond = _ledMatrix->getCount() + MINUTE_LEDS;
+
+  // A new minute, or the time went backwards
+  if (lit < _secondsLit)
   {
-    // Clear all second LEDs
     memset8(_secondLEDs, 0, sizeof(struct CRGB) * SECOND_LEDS);
-    resetBuffer = false;
-    // _secondColor = getRandomColor();  // get a new color only once during the first second
+    markDirty(firstSecond, SECOND_LEDS);
+    _secondsLit = 0;
   }
-  else
+
+  // The gradient may have changed, redraw all lit LEDs
+  if (force)
+    _secondsLit = 0;
+
+  for (; _secondsLit < lit; _secondsLit++)
+  {
+    // Add the offset for the "real" LED number zero
+    uint8_t index = (_secondsLit + SECOND_OFFSET) % SECOND_LEDS;
+    _secondLEDs[index] = _secondGradient[_secondsLit];
+    markDirty(firstSecond + index, 1);
+  }
+#endif
+}
+
+// Only the words which have changed are touched, the other words keep their pixels and their color.
+void WordClock::sendWords(TWORDMASK newWords, bool force)
+{
+  // A new set of words ends a running fade
+  updateFade(true);
+
+  if (force)
   {
-    resetBuffer = true;
+    // Repaint everything with new colors
+    memset8(_leds, 0, sizeof(struct CRGB) * _ledMatrix->getCount());
+    markDirty(0, _ledMatrix->getCount());
+    _currentWords = 0;
   }
 
-  // Fill all LEDs starting from zero. secondIndex is the last LED to be lit.
-  for (int i = 0; i <= secondIndex; i++)
+  TWORDMASK removed = _currentWords & ~newWords;
+  TWORDMASK added = newWords & ~_currentWords;
+
+  for (uint8_t i = 0; i < LAYOUT_WORD_COUNT; i++)
   {
-    _secondColor = getColorFromPalette(255 * i / 60);
+    if (added & wordBit(i))
+    {
+#ifdef DEBUG
+      char buffer[30];
+      strcpy_P(buffer, (char *)pgm_read_ptr(&(LAYOUT_TEXTS[i])));
+      DEBUG_PRINTF(" %d=%s", i, buffer);
+#endif
+      _wordColors[i] = getRandomColor();
+    }
+  }
 
-    // Now add the offset for the "real" LED number zero
-    int ledIndex = (i + SECOND_OFFSET) % SECOND_LEDS;
+  _currentWords = newWords;
 
-    // This fills the second LEDs with the color
-    _secondLEDs[ledIndex] = _secondColor;
+  if ((_fadeTime == 0) || force)
+  {
+    drawWords(removed, 0);
+    // Words which share pixels with a removed word, e.g. "ein" and "eins", have to be repainted
+    drawWords((newWords & ~added) & getOverlaps(removed), 255);
+    drawWords(added, 255);
+  }
+  else
+  {
+    _fadingOut = removed;
+    _fadingIn = added;
+    _fadeStart = millis();
+    _nextFade = _fadeStart;
   }
-#endif
 }
 
-void WordClock::sendWords()
+// Draws the pixels of the fading words, or the final state if the fade is over or finish is true
+void WordClock::updateFade(bool finish)
 {
-  memset8(_leds, 0, sizeof(struct CRGB) * _ledMatrix->getCount());
-  for (size_t i = 0; i < _currentWords.size(); i++)
+  if ((_fadingIn | _fadingOut) == 0)
+    return;
+
+  unsigned long elapsed = millis() - _fadeStart;
+  if (finish || (elapsed >= _fadeTime))
   {
-    sendWord(_currentWords[i]);
+    drawWords(_fadingOut, 0);
+    drawWords(_currentWords & (getOverlaps(_fadingOut) | _fadingIn), 255);
+    _fadingIn = 0;
+    _fadingOut = 0;
+  }
+  else
+  {
+    uint8_t scale = elapsed * 255 / _fadeTime;
+    drawWords(_fadingOut, 255 - scale);
+    drawWords((_currentWords & ~_fadingIn) & getOverlaps(_fadingOut), 255);
+    drawWords(_fadingIn, scale);
   }
 }
 
-void WordClock::sendWord(uint8_t index)
+WordClock::TWORDMASK WordClock::getOverlaps(TWORDMASK words)
 {
-#ifdef DEBUG
-  char buffer[30];
-  strcpy_P(buffer, (char *)pgm_read_dword(&(DEBUGTWORDS[index])));
-  DEBUG_PRINTF(" %d=%s", index, buffer);
-#endif
+  TWORDMASK overlaps = 0;
+  for (uint8_t i = 0; i < LAYOUT_WORD_COUNT; i++)
+  {
+    if (words & wordBit(i))
+      overlaps |= _overlaps[i];
+  }
+  return overlaps;
+}
 
-  CRGB actcolor = getRandomColor();
-  for (int j = 0; j < TLEDS[index].len; j++)
+void WordClock::drawWords(TWORDMASK words, uint8_t scale)
+{
+  for (uint8_t i = 0; words != 0; i++, words >>= 1)
+  {
+    if (words & 0x01)
+    {
+      CRGB color = (scale == 0) ? CRGB(CRGB::Black) : _wordColors[i];
+      if ((scale > 0) && (scale < 255))
+        color.nscale8_video(scale);
+      drawWord(i, color);
+    }
+  }
+}
+
+void WordClock::drawWord(uint8_t index, CRGB color)
+{
+  for (uint8_t i = _firstSpan[index]; i < _firstSpan[index + 1]; i++)
   {
-    _leds[_ledMatrix->toStrip(TLEDS[index].x + j, TLEDS[index].y)] = actcolor;
+    const TSPAN &span = _spans[i];
+    uint16_t first = (span.step > 0) ? span.first : span.first - span.len + 1;
+    fill_solid(&_leds[first], span.len, color);
+    markDirty(first, span.len);
   }
 }
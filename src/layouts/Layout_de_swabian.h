@@ -0,0 +1,115 @@
+/*
+ * Word layout "de_swabian", generated by tools/layoutgen.py from layouts/de_swabian.layout.
+ * Don't edit, change the layout file instead.
+ */
+
+#pragma once
+
+#define LAYOUT_NAME "de_swabian"
+#define LAYOUT_WIDTH 11
+#define LAYOUT_HEIGHT 10
+#define LAYOUT_WORD_COUNT 24
+
+// Word positions with 0,0 at the bottom left
+static const TLAYOUTWORD LAYOUT_WORDS[LAYOUT_WORD_COUNT] PROGMEM = {
+    // x, y, length
+    {0, 9, 2}, // ES
+    {3, 9, 3}, // IST
+    {7, 9, 4}, // M_FUENF
+    {0, 8, 4}, // M_ZEHN
+    {4, 8, 7}, // M_ZWANZIG
+    {0, 7, 11}, // M_DREIVIERTEL
+    {4, 7, 7}, // M_VIERTEL
+    {2, 6, 4}, // NACH
+    {6, 6, 3}, // VOR
+    {0, 5, 4}, // HALB
+    {5, 5, 5}, // H_ZWOELF
+    {0, 4, 4}, // H_ZWEI
+    {2, 4, 3}, // H_EIN
+    {2, 4, 4}, // H_EINS
+    {5, 4, 6}, // H_SIEBEN
+    {1, 3, 4}, // H_DREI
+    {7, 3, 4}, // H_FUENF
+    {0, 2, 3}, // H_ELF
+    {3, 2, 4}, // H_NEUN
+    {7, 2, 4}, // H_VIER
+    {1, 1, 4}, // H_ACHT
+    {5, 1, 4}, // H_ZEHN
+    {1, 0, 5}, // H_SECHS
+    {8, 0, 3}, // UHR
+};
+
+// Word texts as they appear on the face
+static const char LAYOUT_TEXT_0[] PROGMEM = "ES";
+static const char LAYOUT_TEXT_1[] PROGMEM = "IST";
+static const char LAYOUT_TEXT_2[] PROGMEM = "FÜNF";
+static const char LAYOUT_TEXT_3[] PROGMEM = "ZEHN";
+static const char LAYOUT_TEXT_4[] PROGMEM = "ZWANZIG";
+static const char LAYOUT_TEXT_5[] PROGMEM = "DREIVIERTEL";
+static const char LAYOUT_TEXT_6[] PROGMEM = "VIERTEL";
+static const char LAYOUT_TEXT_7[] PROGMEM = "NACH";
+static const char LAYOUT_TEXT_8[] PROGMEM = "VOR";
+static const char LAYOUT_TEXT_9[] PROGMEM = "HALB";
+static const char LAYOUT_TEXT_10[] PROGMEM = "ZWÖLF";
+static const char LAYOUT_TEXT_11[] PROGMEM = "ZWEI";
+static const char LAYOUT_TEXT_12[] PROGMEM = "EIN";
+static const char LAYOUT_TEXT_13[] PROGMEM = "EINS";
+static const char LAYOUT_TEXT_14[] PROGMEM = "SIEBEN";
+static const char LAYOUT_TEXT_15[] PROGMEM = "DREI";
+static const char LAYOUT_TEXT_16[] PROGMEM = "FÜNF";
+static const char LAYOUT_TEXT_17[] PROGMEM = "ELF";
+static const char LAYOUT_TEXT_18[] PROGMEM = "NEUN";
+static const char LAYOUT_TEXT_19[] PROGMEM = "VIER";
+static const char LAYOUT_TEXT_20[] PROGMEM = "ACHT";
+static const char LAYOUT_TEXT_21[] PROGMEM = "ZEHN";
+static const char LAYOUT_TEXT_22[] PROGMEM = "SECHS";
+static const char LAYOUT_TEXT_23[] PROGMEM = "UHR";
+static const char *const LAYOUT_TEXTS[LAYOUT_WORD_COUNT] PROGMEM = {
+    LAYOUT_TEXT_0, LAYOUT_TEXT_1, LAYOUT_TEXT_2, LAYOUT_TEXT_3, LAYOUT_TEXT_4, LAYOUT_TEXT_5, LAYOUT_TEXT_6, LAYOUT_TEXT_7, LAYOUT_TEXT_8, LAYOUT_TEXT_9, LAYOUT_TEXT_10, LAYOUT_TEXT_11, LAYOUT_TEXT_12, LAYOUT_TEXT_13, LAYOUT_TEXT_14, LAYOUT_TEXT_15, LAYOUT_TEXT_16, LAYOUT_TEXT_17, LAYOUT_TEXT_18, LAYOUT_TEXT_19, LAYOUT_TEXT_20, LAYOUT_TEXT_21, LAYOUT_TEXT_22, LAYOUT_TEXT_23};
+
+// Letter grid in UTF-8, top row first
+static const char LAYOUT_ROW_0[] PROGMEM = "ESKISTAFÜNF";
+static const char LAYOUT_ROW_1[] PROGMEM = "ZEHNZWANZIG";
+static const char LAYOUT_ROW_2[] PROGMEM = "DREIVIERTEL";
+static const char LAYOUT_ROW_3[] PROGMEM = "TGNACHVORJM";
+static const char LAYOUT_ROW_4[] PROGMEM = "HALBQZWÖLFP";
+static const char LAYOUT_ROW_5[] PROGMEM = "ZWEINSIEBEN";
+static const char LAYOUT_ROW_6[] PROGMEM = "KDREIRHFÜNF";
+static const char LAYOUT_ROW_7[] PROGMEM = "ELFNEUNVIER";
+static const char LAYOUT_ROW_8[] PROGMEM = "WACHTZEHNRS";
+static const char LAYOUT_ROW_9[] PROGMEM = "BSECHSFMUHR";
+static const char *const LAYOUT_GRID[LAYOUT_HEIGHT] PROGMEM = {
+    LAYOUT_ROW_0, LAYOUT_ROW_1, LAYOUT_ROW_2, LAYOUT_ROW_3, LAYOUT_ROW_4, LAYOUT_ROW_5, LAYOUT_ROW_6, LAYOUT_ROW_7, LAYOUT_ROW_8, LAYOUT_ROW_9};
+
+// Words for each time, indexed by [threeQuarters][5 minute slot][hour % 12].
+// One bit per LAYOUT_WORDS entry.
+static const uint32_t LAYOUT_TIME_WORDS[2][12][12] PROGMEM = {
+    {
+        {0x00800403, 0x00801003, 0x00800803, 0x00808003, 0x00880003, 0x00810003, 0x00c00003, 0x00804003, 0x00900003, 0x00840003, 0x00a00003, 0x00820003}, // :00
+        {0x00000487, 0x00002087, 0x00000887, 0x00008087, 0x00080087, 0x00010087, 0x00400087, 0x00004087, 0x00100087, 0x00040087, 0x00200087, 0x00020087}, // :05
+        {0x0000048b, 0x0000208b, 0x0000088b, 0x0000808b, 0x0008008b, 0x0001008b, 0x0040008b, 0x0000408b, 0x0010008b, 0x0004008b, 0x0020008b, 0x0002008b}, // :10
+        {0x00002043, 0x00000843, 0x00008043, 0x00080043, 0x00010043, 0x00400043, 0x00004043, 0x00100043, 0x00040043, 0x00200043, 0x00020043, 0x00000443}, // :15
+        {0x0000230b, 0x00000b0b, 0x0000830b, 0x0008030b, 0x0001030b, 0x0040030b, 0x0000430b, 0x0010030b, 0x0004030b, 0x0020030b, 0x0002030b, 0x0000070b}, // :20
+        {0x00002307, 0x00000b07, 0x00008307, 0x00080307, 0x00010307, 0x00400307, 0x00004307, 0x00100307, 0x00040307, 0x00200307, 0x00020307, 0x00000707}, // :25
+        {0x00002203, 0x00000a03, 0x00008203, 0x00080203, 0x00010203, 0x00400203, 0x00004203, 0x00100203, 0x00040203, 0x00200203, 0x00020203, 0x00000603}, // :30
+        {0x00002287, 0x00000a87, 0x00008287, 0x00080287, 0x00010287, 0x00400287, 0x00004287, 0x00100287, 0x00040287, 0x00200287, 0x00020287, 0x00000687}, // :35
+        {0x0000228b, 0x00000a8b, 0x0000828b, 0x0008028b, 0x0001028b, 0x0040028b, 0x0000428b, 0x0010028b, 0x0004028b, 0x0020028b, 0x0002028b, 0x0000068b}, // :40
+        {0x00002023, 0x00000823, 0x00008023, 0x00080023, 0x00010023, 0x00400023, 0x00004023, 0x00100023, 0x00040023, 0x00200023, 0x00020023, 0x00000423}, // :45
+        {0x0000210b, 0x0000090b, 0x0000810b, 0x0008010b, 0x0001010b, 0x0040010b, 0x0000410b, 0x0010010b, 0x0004010b, 0x0020010b, 0x0002010b, 0x0000050b}, // :50
+        {0x00002107, 0x00000907, 0x00008107, 0x00080107, 0x00010107, 0x00400107, 0x00004107, 0x00100107, 0x00040107, 0x00200107, 0x00020107, 0x00000507}, // :55
+    },
+    {
+        {0x00800403, 0x00801003, 0x00800803, 0x00808003, 0x00880003, 0x00810003, 0x00c00003, 0x00804003, 0x00900003, 0x00840003, 0x00a00003, 0x00820003}, // :00
+        {0x00000487, 0x00002087, 0x00000887, 0x00008087, 0x00080087, 0x00010087, 0x00400087, 0x00004087, 0x00100087, 0x00040087, 0x00200087, 0x00020087}, // :05
+        {0x0000048b, 0x0000208b, 0x0000088b, 0x0000808b, 0x0008008b, 0x0001008b, 0x0040008b, 0x0000408b, 0x0010008b, 0x0004008b, 0x0020008b, 0x0002008b}, // :10
+        {0x00002043, 0x00000843, 0x00008043, 0x00080043, 0x00010043, 0x00400043, 0x00004043, 0x00100043, 0x00040043, 0x00200043, 0x00020043, 0x00000443}, // :15
+        {0x0000230b, 0x00000b0b, 0x0000830b, 0x0008030b, 0x0001030b, 0x0040030b, 0x0000430b, 0x0010030b, 0x0004030b, 0x0020030b, 0x0002030b, 0x0000070b}, // :20
+        {0x00002307, 0x00000b07, 0x00008307, 0x00080307, 0x00010307, 0x00400307, 0x00004307, 0x00100307, 0x00040307, 0x00200307, 0x00020307, 0x00000707}, // :25
+        {0x00002203, 0x00000a03, 0x00008203, 0x00080203, 0x00010203, 0x00400203, 0x00004203, 0x00100203, 0x00040203, 0x00200203, 0x00020203, 0x00000603}, // :30
+        {0x00002287, 0x00000a87, 0x00008287, 0x00080287, 0x00010287, 0x00400287, 0x00004287, 0x00100287, 0x00040287, 0x00200287, 0x00020287, 0x00000687}, // :35
+        {0x0000228b, 0x00000a8b, 0x0000828b, 0x0008028b, 0x0001028b, 0x0040028b, 0x0000428b, 0x0010028b, 0x0004028b, 0x0020028b, 0x0002028b, 0x0000068b}, // :40
+        {0x00002023, 0x00000823, 0x00008023, 0x00080023, 0x00010023, 0x00400023, 0x00004023, 0x00100023, 0x00040023, 0x00200023, 0x00020023, 0x00000423}, // :45
+        {0x0000210b, 0x0000090b, 0x0000810b, 0x0008010b, 0x0001010b, 0x0040010b, 0x0000410b, 0x0010010b, 0x0004010b, 0x0020010b, 0x0002010b, 0x0000050b}, // :50
+        {0x00002107, 0x00000907, 0x00008107, 0x00080107, 0x00010107, 0x00400107, 0x00004107, 0x00100107, 0x00040107, 0x00200107, 0x00020107, 0x00000507}, // :55
+    },
+};
@@ -0,0 +1,113 @@
+/*
+ * Word layout "en", generated by tools/layoutgen.py from layouts/en.layout.
+ * Don't edit, change the layout file instead.
+ */
+
+#pragma once
+
+#define LAYOUT_NAME "en"
+#define LAYOUT_WIDTH 11
+#define LAYOUT_HEIGHT 10
+#define LAYOUT_WORD_COUNT 23
+
+// Word positions with 0,0 at the bottom left
+static const TLAYOUTWORD LAYOUT_WORDS[LAYOUT_WORD_COUNT] PROGMEM = {
+    // x, y, length
+    {0, 9, 2}, // IT
+    {3, 9, 2}, // IS
+    {0, 8, 1}, // A
+    {2, 8, 7}, // M_QUARTER
+    {0, 7, 6}, // M_TWENTY
+    {6, 7, 4}, // M_FIVE
+    {0, 6, 4}, // HALF
+    {5, 6, 3}, // M_TEN
+    {9, 6, 2}, // TO
+    {0, 5, 4}, // PAST
+    {7, 5, 4}, // H_NINE
+    {0, 4, 3}, // H_ONE
+    {3, 4, 3}, // H_SIX
+    {6, 4, 5}, // H_THREE
+    {0, 3, 4}, // H_FOUR
+    {4, 3, 4}, // H_FIVE
+    {8, 3, 3}, // H_TWO
+    {0, 2, 5}, // H_EIGHT
+    {5, 2, 6}, // H_ELEVEN
+    {0, 1, 5}, // H_SEVEN
+    {5, 1, 6}, // H_TWELVE
+    {0, 0, 3}, // H_TEN
+    {5, 0, 6}, // OCLOCK
+};
+
+// Word texts as they appear on the face
+static const char LAYOUT_TEXT_0[] PROGMEM = "IT";
+static const char LAYOUT_TEXT_1[] PROGMEM = "IS";
+static const char LAYOUT_TEXT_2[] PROGMEM = "A";
+static const char LAYOUT_TEXT_3[] PROGMEM = "QUARTER";
+static const char LAYOUT_TEXT_4[] PROGMEM = "TWENTY";
+static const char LAYOUT_TEXT_5[] PROGMEM = "FIVE";
+static const char LAYOUT_TEXT_6[] PROGMEM = "HALF";
+static const char LAYOUT_TEXT_7[] PROGMEM = "TEN";
+static const char LAYOUT_TEXT_8[] PROGMEM = "TO";
+static const char LAYOUT_TEXT_9[] PROGMEM = "PAST";
+static const char LAYOUT_TEXT_10[] PROGMEM = "NINE";
+static const char LAYOUT_TEXT_11[] PROGMEM = "ONE";
+static const char LAYOUT_TEXT_12[] PROGMEM = "SIX";
+static const char LAYOUT_TEXT_13[] PROGMEM = "THREE";
+static const char LAYOUT_TEXT_14[] PROGMEM = "FOUR";
+static const char LAYOUT_TEXT_15[] PROGMEM = "FIVE";
+static const char LAYOUT_TEXT_16[] PROGMEM = "TWO";
+static const char LAYOUT_TEXT_17[] PROGMEM = "EIGHT";
+static const char LAYOUT_TEXT_18[] PROGMEM = "ELEVEN";
+static const char LAYOUT_TEXT_19[] PROGMEM = "SEVEN";
+static const char LAYOUT_TEXT_20[] PROGMEM = "TWELVE";
+static const char LAYOUT_TEXT_21[] PROGMEM = "TEN";
+static const char LAYOUT_TEXT_22[] PROGMEM = "OCLOCK";
+static const char *const LAYOUT_TEXTS[LAYOUT_WORD_COUNT] PROGMEM = {
+    LAYOUT_TEXT_0, LAYOUT_TEXT_1, LAYOUT_TEXT_2, LAYOUT_TEXT_3, LAYOUT_TEXT_4, LAYOUT_TEXT_5, LAYOUT_TEXT_6, LAYOUT_TEXT_7, LAYOUT_TEXT_8, LAYOUT_TEXT_9, LAYOUT_TEXT_10, LAYOUT_TEXT_11, LAYOUT_TEXT_12, LAYOUT_TEXT_13, LAYOUT_TEXT_14, LAYOUT_TEXT_15, LAYOUT_TEXT_16, LAYOUT_TEXT_17, LAYOUT_TEXT_18, LAYOUT_TEXT_19, LAYOUT_TEXT_20, LAYOUT_TEXT_21, LAYOUT_TEXT_22};
+
+// Letter grid in UTF-8, top row first
+static const char LAYOUT_ROW_0[] PROGMEM = "ITLISASAMPM";
+static const char LAYOUT_ROW_1[] PROGMEM = "ACQUARTERDC";
+static const char LAYOUT_ROW_2[] PROGMEM = "TWENTYFIVEX";
+static const char LAYOUT_ROW_3[] PROGMEM = "HALFSTENFTO";
+static const char LAYOUT_ROW_4[] PROGMEM = "PASTERUNINE";
+static const char LAYOUT_ROW_5[] PROGMEM = "ONESIXTHREE";
+static const char LAYOUT_ROW_6[] PROGMEM = "FOURFIVETWO";
+static const char LAYOUT_ROW_7[] PROGMEM = "EIGHTELEVEN";
+static const char LAYOUT_ROW_8[] PROGMEM = "SEVENTWELVE";
+static const char LAYOUT_ROW_9[] PROGMEM = "TENSEOCLOCK";
+static const char *const LAYOUT_GRID[LAYOUT_HEIGHT] PROGMEM = {
+    LAYOUT_ROW_0, LAYOUT_ROW_1, LAYOUT_ROW_2, LAYOUT_ROW_3, LAYOUT_ROW_4, LAYOUT_ROW_5, LAYOUT_ROW_6, LAYOUT_ROW_7, LAYOUT_ROW_8, LAYOUT_ROW_9};
+
+// Words for each time, indexed by [threeQuarters][5 minute slot][hour % 12].
+// One bit per LAYOUT_WORDS entry.
+static const uint32_t LAYOUT_TIME_WORDS[2][12][12] PROGMEM = {
+    {
+        {0x00500003, 0x00400803, 0x00410003, 0x00402003, 0x00404003, 0x00408003, 0x00401003, 0x00480003, 0x00420003, 0x00400403, 0x00600003, 0x00440003}, // :00
+        {0x00100223, 0x00000a23, 0x00010223, 0x00002223, 0x00004223, 0x00008223, 0x00001223, 0x00080223, 0x00020223, 0x00000623, 0x00200223, 0x00040223}, // :05
+        {0x00100283, 0x00000a83, 0x00010283, 0x00002283, 0x00004283, 0x00008283, 0x00001283, 0x00080283, 0x00020283, 0x00000683, 0x00200283, 0x00040283}, // :10
+        {0x0010020f, 0x00000a0f, 0x0001020f, 0x0000220f, 0x0000420f, 0x0000820f, 0x0000120f, 0x0008020f, 0x0002020f, 0x0000060f, 0x0020020f, 0x0004020f}, // :15
+        {0x00100213, 0x00000a13, 0x00010213, 0x00002213, 0x00004213, 0x00008213, 0x00001213, 0x00080213, 0x00020213, 0x00000613, 0x00200213, 0x00040213}, // :20
+        {0x00100233, 0x00000a33, 0x00010233, 0x00002233, 0x00004233, 0x00008233, 0x00001233, 0x00080233, 0x00020233, 0x00000633, 0x00200233, 0x00040233}, // :25
+        {0x00100243, 0x00000a43, 0x00010243, 0x00002243, 0x00004243, 0x00008243, 0x00001243, 0x00080243, 0x00020243, 0x00000643, 0x00200243, 0x00040243}, // :30
+        {0x00000933, 0x00010133, 0x00002133, 0x00004133, 0x00008133, 0x00001133, 0x00080133, 0x00020133, 0x00000533, 0x00200133, 0x00040133, 0x00100133}, // :35
+        {0x00000913, 0x00010113, 0x00002113, 0x00004113, 0x00008113, 0x00001113, 0x00080113, 0x00020113, 0x00000513, 0x00200113, 0x00040113, 0x00100113}, // :40
+        {0x0000090f, 0x0001010f, 0x0000210f, 0x0000410f, 0x0000810f, 0x0000110f, 0x0008010f, 0x0002010f, 0x0000050f, 0x0020010f, 0x0004010f, 0x0010010f}, // :45
+        {0x00000983, 0x00010183, 0x00002183, 0x00004183, 0x00008183, 0x00001183, 0x00080183, 0x00020183, 0x00000583, 0x00200183, 0x00040183, 0x00100183}, // :50
+        {0x00000923, 0x00010123, 0x00002123, 0x00004123, 0x00008123, 0x00001123, 0x00080123, 0x00020123, 0x00000523, 0x00200123, 0x00040123, 0x00100123}, // :55
+    },
+    {
+        {0x00500003, 0x00400803, 0x00410003, 0x00402003, 0x00404003, 0x00408003, 0x00401003, 0x00480003, 0x00420003, 0x00400403, 0x00600003, 0x00440003}, // :00
+        {0x00100223, 0x00000a23, 0x00010223, 0x00002223, 0x00004223, 0x00008223, 0x00001223, 0x00080223, 0x00020223, 0x00000623, 0x00200223, 0x00040223}, // :05
+        {0x00100283, 0x00000a83, 0x00010283, 0x00002283, 0x00004283, 0x00008283, 0x00001283, 0x00080283, 0x00020283, 0x00000683, 0x00200283, 0x00040283}, // :10
+        {0x0010020f, 0x00000a0f, 0x0001020f, 0x0000220f, 0x0000420f, 0x0000820f, 0x0000120f, 0x0008020f, 0x0002020f, 0x0000060f, 0x0020020f, 0x0004020f}, // :15
+        {0x00100213, 0x00000a13, 0x00010213, 0x00002213, 0x00004213, 0x00008213, 0x00001213, 0x00080213, 0x00020213, 0x00000613, 0x00200213, 0x00040213}, // :20
+        {0x00100233, 0x00000a33, 0x00010233, 0x00002233, 0x00004233, 0x00008233, 0x00001233, 0x00080233, 0x00020233, 0x00000633, 0x00200233, 0x00040233}, // :25
+        {0x00100243, 0x00000a43, 0x00010243, 0x00002243, 0x00004243, 0x00008243, 0x00001243, 0x00080243, 0x00020243, 0x00000643, 0x00200243, 0x00040243}, // :30
+        {0x00000933, 0x00010133, 0x00002133, 0x00004133, 0x00008133, 0x00001133, 0x00080133, 0x00020133, 0x00000533, 0x00200133, 0x00040133, 0x00100133}, // :35
+        {0x00000913, 0x00010113, 0x00002113, 0x00004113, 0x00008113, 0x00001113, 0x00080113, 0x00020113, 0x00000513, 0x00200113, 0x00040113, 0x00100113}, // :40
+        {0x0000090f, 0x0001010f, 0x0000210f, 0x0000410f, 0x0000810f, 0x0000110f, 0x0008010f, 0x0002010f, 0x0000050f, 0x0020010f, 0x0004010f, 0x0010010f}, // :45
+        {0x00000983, 0x00010183, 0x00002183, 0x00004183, 0x00008183, 0x00001183, 0x00080183, 0x00020183, 0x00000583, 0x00200183, 0x00040183, 0x00100183}, // :50
+        {0x00000923, 0x00010123, 0x00002123, 0x00004123, 0x00008123, 0x00001123, 0x00080123, 0x00020123, 0x00000523, 0x00200123, 0x00040123, 0x00100123}, // :55
+    },
+};
@@ -0,0 +1,28 @@
+/*
+ * Word layout selection, generated by tools/layoutgen.py.
+ * Don't edit, add a layout file to layouts/ instead.
+ *
+ * Select a layout with -D WORD_LAYOUT_<NAME>, the default is "de".
+ * Include this file in one translation unit only, every inclusion adds a copy of the tables to flash.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+struct TLAYOUTWORD
+{
+  uint8_t x;
+  uint8_t y;
+  uint8_t len;
+};
+
+#if defined(WORD_LAYOUT_DE)
+#include "Layout_de.h"
+#elif defined(WORD_LAYOUT_DE_SWABIAN)
+#include "Layout_de_swabian.h"
+#elif defined(WORD_LAYOUT_EN)
+#include "Layout_en.h"
+#else
+#include "Layout_de.h"
+#endif
@@ -1,8 +1,11 @@
 #include <FastLED.h>
 #include <ESP8266WiFi.h>
-#include <Ticker.h>
 #include <espMqttClient.h>
 #include <BH1750.h>
+extern "C"
+{
+#include <user_interface.h>
+}
 #include <MedianFilterLib.h>
 #include <MeanFilterLib.h>
 
@@ -15,6 +18,11 @@
 #include "ArduinoBorealis.h"
 #include "MatrixAnimation.h"
 #include "MoodLight.h"
+#include "Compositor.h"
+#include "LedOutput.h"
+#include "Profiler.h"
+#include "Scheduler.h"
+#include "StallDetector.h"
 
 #include "HaMqttConfigBuilder.h"
 
@@ -36,6 +44,18 @@
 #define COLOR_ORDER GRB
 #define CHIPSET WS2812
 
+// Uncomment one of the following lines to send the frames in the background without disabling interrupts.
+// Both need the LED data line on a different pin than PIN_LED:
+// #define LED_OUTPUT_DMA   // I2S DMA on GPIO3 (RX)
+// #define LED_OUTPUT_UART  // UART1 on GPIO2 (D4)
+
+#if defined(LED_OUTPUT_DMA) || defined(LED_OUTPUT_UART)
+#include "NeoPixelBusOutput.h"
+#endif
+
+#define MAX_POWER_V 5     // Power limit for the LEDs 5V, 2A
+#define MAX_POWER_MA 2000
+
 // LED matrix of 11x10 pixels with 0,0 at the bottom left
 // The matrix has to be the *first* section of the LED chain, because of the "safety pixel"
 #define MATRIX_WIDTH 11
@@ -51,6 +71,12 @@
 #define SEND_STATS_INTERVAL 60 * 1000UL // Send stats every 60 seconds
 #define SEND_LIGHT_INTERVAL 5 * 1000UL  // Send light level every 5 seconds
 #define CHECK_LIGHT_INTERVAL 50UL       // Check light level 20 times per second
+#define MAX_IDLE_MS 10UL                // MQTT, OTA, NTP and the effects are polled this often, keeps them responsive
+#define LED_REFRESH_MS 10 * 1000UL      // Send an unchanged frame again after 10 seconds, 0 = never
+#define DORMANT_IDLE_MS 100UL           // Poll interval while the matrix is off, delays MQTT commands at most this long
+#define RECONNECT_DELAY_MS 2000UL       // Wait before reconnecting to WiFi or MQTT
+#define SNTP_POLL_MS 1UL                // Poll interval while a NTP reply is pending, adds at most this much to the receive time
+#define DORMANT_CPU_MHZ 80              // CPU clock while the matrix is off
 
 #define MEDIAN_WND 7 // A median filter window size of seven should be enough to filter out most spikes
 #define MEAN_WND 7   // After filtering the spikes we don't need many samples anymore for the average
@@ -62,43 +88,66 @@
 CRGB leds_plus_safety_pixel[NUM_LEDS + 1];    // The first pixel in this array is the safety pixel for "out of bounds" results. Never use this array directly!
 CRGB *const leds(leds_plus_safety_pixel + 1); // This is the "off-by-one" array that we actually work with and which is passed to FastLED!
 
-LedMatrix ledMatrix(MATRIX_WIDTH, MATRIX_HEIGHT);
+StaticLedMatrix<MATRIX_WIDTH, MATRIX_HEIGHT> ledMatrix;
 LedEffect *_ledEffect = nullptr;
 
+// The effects draw into separate layers, which are composited into "leds" once per frame
+Compositor compositor(leds, NUM_LEDS);
+
 BH1750 lightMeter;
 
 MedianFilter<float> medianFilterLDR(MEDIAN_WND);
 MeanFilter<float> meanFilterLDR(MEAN_WND);
 
-OtaHelper otaHelper(&ledMatrix, leds, NUM_LEDS);
+#if defined(LED_OUTPUT_DMA)
+NeoPixelBusOutput<NeoEsp8266DmaWs2812xMethod> ledOutput(NUM_LEDS, TypicalLEDStrip, MAX_POWER_V, MAX_POWER_MA);
+#elif defined(LED_OUTPUT_UART)
+NeoPixelBusOutput<NeoEsp8266AsyncUart1Ws2812xMethod> ledOutput(NUM_LEDS, TypicalLEDStrip, MAX_POWER_V, MAX_POWER_MA);
+#else
+FastLedOutput ledOutput;
+#endif
 
-WordClock wordClock(&ledMatrix, leds, NUM_LEDS, onGetTime);
+OtaHelper otaHelper(&ledMatrix, &ledOutput, leds, NUM_LEDS);
 
-MoodLight moodLight(&ledMatrix, leds, NUM_LEDS);
-StatusAnimation statusAnimation(&ledMatrix, leds, NUM_LEDS);
-SnakeAnimation snakeAnimation(&ledMatrix, leds, NUM_LEDS);
-RainbowAnimation rainbowAnimation(&ledMatrix, leds, NUM_LEDS);
-BorealisAnimation borealisAnimation(&ledMatrix, leds, NUM_LEDS);
-MatrixAnimation matrixAnimation(&ledMatrix, leds, NUM_LEDS);
+WordClock wordClock(&ledMatrix, compositor.getLayer(LAYER_BASE), compositor.getLayer(LAYER_ACCENTS), NUM_LEDS, onGetTime);
+
+MoodLight moodLight(&ledMatrix, compositor.getLayer(LAYER_BASE), NUM_LEDS);
+StatusAnimation statusAnimation(&ledMatrix, compositor.getLayer(LAYER_OVERLAY), NUM_LEDS);
+SnakeAnimation snakeAnimation(&ledMatrix, compositor.getLayer(LAYER_BASE), NUM_LEDS);
+RainbowAnimation rainbowAnimation(&ledMatrix, compositor.getLayer(LAYER_BASE), NUM_LEDS);
+BorealisAnimation borealisAnimation(&ledMatrix, compositor.getLayer(LAYER_BASE), NUM_LEDS);
+MatrixAnimation matrixAnimation(&ledMatrix, compositor.getLayer(LAYER_BASE), NUM_LEDS);
 
 WiFiEventHandler wifiConnectHandler;
 WiFiEventHandler wifiDisconnectHandler;
-Ticker wifiReconnectTimer;
 
 espMqttClient mqttClient;
-Ticker mqttReconnectTimer;
+
+// All work of the main loop runs as a task of the scheduler
+Scheduler scheduler;
+TTaskId _frameTask = -1;
+TTaskId _lightTask = -1;
+TTaskId _mqttTask = -1;
+TTaskId _otaTask = -1;
+TTaskId _timeTask = -1;
+TTaskId _statsTask = -1;
+TTaskId _stateTask = -1;
+TTaskId _wifiReconnectTask = -1;
+TTaskId _mqttReconnectTask = -1;
 
 String _currLight = "";
 String _currPalette = "";
 String _currMode = "";
 String _prevMode = "";
 bool _modeChanged = false;
+bool _dormant = false;       // The matrix is off, only the network is serviced
+uint8_t _awakeCpuMhz = 0;    // CPU clock and WiFi sleep mode to return to when the matrix is switched on again
+WiFiSleepType_t _awakeSleepMode = WIFI_NONE_SLEEP;
 bool _initialized = false;
-uint64_t _lastStatsSent = 0;
 
 bool _lightMeterOK = false;
-uint64_t _lastLightLevelCheck = 0;
-uint64_t _lastLightSent = 0;
+unsigned long _lastShow = 0;   // millis() and brightness of the last frame sent to the LEDs
+uint8_t _lastBrightness = 0;
 float _lux = NAN;
 byte _mtReg = 0;
 
@@ -122,14 +171,19 @@ Uptime _uptimeWifi;
 #define cUptime "uptime"
 #define cUptimeWifi "uptimewifi"
 #define cUptimeMqtt "uptimemqtt"
+#define cNtp "ntp"
+#define cProfile "profile"
+#define cTasks "tasks"
+#define cStall "stall"
 
 // Operation mode
 #define cLightlevel "lightlevel"
 #define cBrightness "brightness"
 #define cMode "mode"
-#define cModeOptions "[\"Off\",\"Clock\",\"Rainbow\",\"Borealis\",\"Matrix\",\"Snake\"]"
+#define cModeOptions "[\"Off\",\"Clock\",\"Mood\",\"Rainbow\",\"Borealis\",\"Matrix\",\"Snake\"]"
 #define cMatrix "matrix"
 #define cPalette "palette"
+#define cColor "color"
 #define cPaletteOptions "[\"Rainbow\",\"Lava\",\"Cloud\",\"Ocean\",\"Forest\",\"Party\",\"Heat\",\"Random\"]"
 #define cThreeQuarters "threequarters"
 
@@ -141,6 +195,7 @@ String _availabilityTopic;
 String _setMatrixTopic;
 String _setModeTopic;
 String _setPaletteTopic;
+String _setColorTopic;
 String _setThreeQuartersTopic;
 
 void prepareMqttTopics()
@@ -163,6 +218,7 @@ void prepareMqttTopics()
   _setMatrixTopic = _baseTopic + String("/") + cMatrix + "/set";
   _setModeTopic = _baseTopic + String("/") + cMode + "/set";
   _setPaletteTopic = _baseTopic + String("/") + cPalette + "/set";
+  _setColorTopic = _baseTopic + String("/") + cColor + "/set";
   _setThreeQuartersTopic = _baseTopic + String("/") + cThreeQuarters + "/set";
 }
 
@@ -256,6 +312,110 @@ void sendStats()
   sendWithPrefix(cStatsTopic "/" cUptimeWifi, statusStr);
   itoa(_uptimeMqtt.getSeconds(), statusStr, 10);
   sendWithPrefix(cStatsTopic "/" cUptimeMqtt, statusStr);
+
+  // Selected server, last sync error in ms, drift correction in ppb and sync interval in s
+  const char *server = sntpClient.getSelectedServer();
+  char ntpStr[128];
+  snprintf(ntpStr, sizeof(ntpStr), "{\"server\":\"%s\",\"error\":%d,\"drift\":%d,\"interval\":%lu}",
+           server ? server : "", (int)localTime.getLastError(), (int)localTime.getDrift(), localTime.getSyncInterval() / 1000);
+  sendWithPrefix(cStatsTopic "/" cNtp, ntpStr);
+}
+
+#ifdef PROFILING
+void sendProfile()
+{
+  DEBUG_PRINTLN(F("Sending Profile"));
+
+  const uint8_t MAX_PROFILE_LENGTH = 96;
+  char profileStr[MAX_PROFILE_LENGTH];
+  TProfileStats stats;
+
+  for (uint8_t zone = 0; zone < ZONE_COUNT; zone++)
+  {
+    if (profiler.getStats(zone, stats))
+    {
+      // All times in microseconds
+      snprintf(profileStr, MAX_PROFILE_LENGTH, "{\"n\":%u,\"min\":%u,\"avg\":%u,\"max\":%u,\"p99\":%u}",
+               (unsigned)stats.count, (unsigned)stats.minUs, (unsigned)stats.avgUs, (unsigned)stats.maxUs, (unsigned)stats.p99Us);
+      sendWithPrefix(String(cStatsTopic "/" cProfile "/") + FPSTR(getZoneName(zone)), profileStr);
+    }
+  }
+
+  // Every publish covers the time since the previous one
+  profiler.reset();
+}
+#endif
+
+void sendTasks()
+{
+  DEBUG_PRINTLN(F("Sending Tasks"));
+
+  const uint8_t MAX_TASK_LENGTH = 64;
+  char taskStr[MAX_TASK_LENGTH];
+
+  for (uint8_t i = 0; i < scheduler.getTaskCount(); i++)
+  {
+    // Runs, overruns and the longest delay after the deadline in ms
+    const TTask &task = scheduler.getTask(i);
+    snprintf(taskStr, MAX_TASK_LENGTH, "{\"n\":%u,\"overruns\":%u,\"late\":%lu}",
+             (unsigned)task.runs, (unsigned)task.overruns, task.maxLate);
+    sendWithPrefix(String(cStatsTopic "/" cTasks "/") + task.name, taskStr);
+  }
+
+  // Every publish covers the time since the previous one
+  scheduler.resetStats();
+}
+
+void sendStall()
+{
+  TStallRecord record;
+
+  if (stallDetector.readRecord(record))
+  {
+    DEBUG_PRINTLN(F("Sending Stall"));
+
+    const uint8_t MAX_STALL_LENGTH = 128;
+    char stallStr[MAX_STALL_LENGTH];
+
+    snprintf(stallStr, MAX_STALL_LENGTH, "{\"reason\":\"%s\",\"phase\":\"%s\",\"us\":%u,\"uptime\":%u,\"count\":%u}",
+             String(FPSTR(StallDetector::getReasonName(record.reason))).c_str(), String(FPSTR(getZoneName(record.phase))).c_str(),
+             (unsigned)record.durationUs, (unsigned)record.uptimeS, (unsigned)record.count);
+    sendWithPrefix(cStatsTopic "/" cStall, stallStr);
+
+    stallDetector.clearRecord();
+  }
+}
+
+// While the matrix is off the CPU clock is lowered and the WiFi modem sleeps between the beacons.
+// The loop only services the network until a command switches the matrix on again.
+void setDormant(bool dormant)
+{
+  if (dormant == _dormant)
+    return;
+
+  _dormant = dormant;
+  if (dormant)
+  {
+    _awakeCpuMhz = system_get_cpu_freq();
+    _awakeSleepMode = WiFi.getSleepMode();
+    if (_awakeCpuMhz > DORMANT_CPU_MHZ)
+      system_update_cpu_freq(DORMANT_CPU_MHZ);
+    WiFi.setSleepMode(WIFI_MODEM_SLEEP);
+    scheduler.cancel(_lightTask);
+  }
+  else
+  {
+    if (_awakeCpuMhz > DORMANT_CPU_MHZ)
+      system_update_cpu_freq(_awakeCpuMhz);
+    WiFi.setSleepMode(_awakeSleepMode);
+    scheduler.schedule(_lightTask, 0);
+  }
+
+  unsigned long pollInterval = dormant ? DORMANT_IDLE_MS : MAX_IDLE_MS;
+  scheduler.setInterval(_mqttTask, pollInterval);
+  scheduler.setInterval(_otaTask, pollInterval);
+  scheduler.setInterval(_timeTask, pollInterval);
+  DEBUG_PRINTF("Dormant %d, CPU %d MHz\r\n", dormant, system_get_cpu_freq());
 }
 
 void setMode(String mode)
@@ -264,15 +424,22 @@ void setMode(String mode)
 
   if (mode != _currMode)
   {
-    FastLED.clear(true);
+    // Start the new mode from a blank canvas, the status overlay stays
+    compositor.clear(LAYER_BASE);
+    compositor.clear(LAYER_ACCENTS);
 
     if (mode == "Off")
     {
+      // The overlay isn't painted while dormant, so its pixels are cleared as well.
+      // The cleared layers go out as one blank frame, then there is nothing left to paint.
+      compositor.clear(LAYER_OVERLAY);
       _prevMode = _currMode;
-      _ledEffect = &moodLight;
+      _ledEffect = nullptr;
     }
     else if (mode == "Clock")
       _ledEffect = &wordClock;
+    else if (mode == "Mood")
+      _ledEffect = &moodLight;
     else if (mode == "Rainbow")
       _ledEffect = &rainbowAnimation;
     else if (mode == "Borealis")
@@ -288,7 +455,9 @@ void setMode(String mode)
     }
     _currLight = (mode == "Off") ? "Off" : "On";
     _currMode = mode;
-    _modeChanged = true;
+    _modeChanged = (_ledEffect != nullptr);
+    setDormant(_ledEffect == nullptr);
+    scheduler.schedule(_frameTask, 0);
 
     sendWithPrefix(cMatrix, _currLight.c_str());
     sendWithPrefix(cMode, _currMode.c_str());
@@ -300,7 +469,8 @@ void setPalette(String palette)
   // Color palette is up to now only used for the word clock
   DEBUG_PRINTF("Palette:%s->%s\r\n", _currPalette.c_str(), palette.c_str());
 
-  if (palette != _currPalette)
+  // Nothing to apply the palette to while the matrix is off
+  if (_ledEffect && (palette != _currPalette))
   {
     if (palette == "Rainbow")
       _ledEffect->setPalette(RainbowColors_p);
@@ -322,11 +492,27 @@ void setPalette(String palette)
     DEBUG_PRINTF("Palette:%s->%s\r\n", _currPalette.c_str(), palette.c_str());
 
     _currPalette = palette;
+    // Repaint with the new colors on the next frame
+    _modeChanged = true;
+    scheduler.schedule(_frameTask, 0);
 
     sendWithPrefix(cPalette, _currPalette.c_str());
   }
 }
 
+// Color of the mood light as "r,g,b", which is the format of the rgb topics of Home Assistant
+void setColor(String color)
+{
+  int r, g, b;
+  if (sscanf(color.c_str(), "%d,%d,%d", &r, &g, &b) == 3)
+    moodLight.setColor(CRGB(constrain(r, 0, 255), constrain(g, 0, 255), constrain(b, 0, 255)));
+
+  CRGB current = moodLight.getColor();
+  char colorStr[12];
+  snprintf(colorStr, sizeof(colorStr), "%d,%d,%d", current.r, current.g, current.b);
+  sendWithPrefix(cColor, colorStr);
+}
+
 void setLight(String cmd)
 {
   DEBUG_PRINTF("Set Light %s\r\n", cmd.c_str());
@@ -367,6 +553,7 @@ void onMqttConnect(bool sessionPresent)
   subscribeToMqtt(_setMatrixTopic);
   subscribeToMqtt(_setModeTopic);
   subscribeToMqtt(_setPaletteTopic);
+  subscribeToMqtt(_setColorTopic);
   subscribeToMqtt(_setThreeQuartersTopic);
 
   sendWithPrefix(cFirmwareName, FW_NAME);
@@ -377,12 +564,20 @@ void onMqttConnect(bool sessionPresent)
   sendWithPrefix(cMacTopic, WiFi.macAddress().c_str());
   sendWithPrefix(cAvailabilityTopic, cPlAvailable);
 
+  // Evidence of a stall or a crash during the previous connection or before the last reset
+  sendStall();
+
   createAutoDiscovery();
 
+  // Publish the statistics and the state right away, not only after their first interval
+  scheduler.schedule(_statsTask, 0);
+  scheduler.schedule(_stateTask, 0);
+
   // Set palette and mode to force sending their status to MQTT
   // Default values on first connect
   setPalette(_initialized ? _currPalette : "Rainbow");
   setMode(_initialized ? _currMode : "Clock");
+  setColor("");
   setThreeQuarters(wordClock.getUseThreeQuarters());
   _initialized = true;
 }
@@ -394,7 +589,7 @@ void onMqttDisconnect(espMqttClientTypes::DisconnectReason reason)
   statusAnimation.setStatus(CLOCK_STATUS::MQTT_DISCONNECTED);
   if (WiFi.isConnected())
   {
-    mqttReconnectTimer.once(2, connectToMqtt);
+    scheduler.schedule(_mqttReconnectTask, RECONNECT_DELAY_MS);
   }
 }
 
@@ -416,6 +611,8 @@ void onMqttMessage(const espMqttClientTypes::MessageProperties &properties, cons
       setMode(strval);
     else if (_setPaletteTopic.compareTo(topic) == 0)
       setPalette(strval);
+    else if (_setColorTopic.compareTo(topic) == 0)
+      setColor(strval);
     else if (_setThreeQuartersTopic.compareTo(topic) == 0)
       setThreeQuarters((strcmp(strval, "On") == 0) || (strcmp(strval, "on") == 0) || (strcmp(strval, "1") == 0));
 
@@ -442,7 +639,7 @@ void onWifiConnect(const WiFiEventStationModeGotIP &event)
   connectToMqtt();
 
   // initialize NTP Client after WiFi is connected
-  timeClient.begin();
+  sntpClient.begin();
 }
 
 void onWifiDisconnect(const WiFiEventStationModeDisconnected &event)
@@ -450,8 +647,8 @@ void onWifiDisconnect(const WiFiEventStationModeDisconnected &event)
   DEBUG_PRINTLN(F("Disconnected from Wi-Fi."));
 
   statusAnimation.setStatus(CLOCK_STATUS::WIFI_DISCONNECTED);
-  mqttReconnectTimer.detach(); // ensure we don't reconnect to MQTT while reconnecting to Wi-Fi
-  wifiReconnectTimer.once(2, connectToWifi);
+  scheduler.cancel(_mqttReconnectTask); // ensure we don't reconnect to MQTT while reconnecting to Wi-Fi
+  scheduler.schedule(_wifiReconnectTask, RECONNECT_DELAY_MS);
 }
 
 // Automatic brightness adjustment for LEDs via BH1750 light sensor
@@ -479,6 +676,27 @@ void adjustBrightness(float lux)
   FastLED.setBrightness(brightness);
 }
 
+// Sends the output buffer to the LEDs
+void showFrame()
+{
+  _lastShow = millis();
+  _lastBrightness = FastLED.getBrightness();
+  ledOutput.submit(leds, NUM_LEDS, _lastBrightness);
+}
+
+// Unchanged frames are only sent again for a new brightness or as keep alive,
+// which repairs pixels that have picked up noise on the data line
+bool isShowDue(bool changed)
+{
+  if (changed)
+    return true;
+  // The blank frame of the off mode is sent once and left alone
+  if (_dormant)
+    return false;
+  return (FastLED.getBrightness() != _lastBrightness) ||
+         ((LED_REFRESH_MS > 0) && isDue(_lastShow + LED_REFRESH_MS, millis()));
+}
+
 void setMTreg(uint8_t mtReg)
 {
   if (_mtReg != mtReg)
@@ -532,6 +750,120 @@ void checkLightLevel()
   }
 }
 
+// Deadline of the next frame: a pending frame is due right away, otherwise the earliest
+// deadline of the effects. Status changes and new brightness values are picked up within MAX_IDLE_MS.
+unsigned long getNextFrame()
+{
+  unsigned long now = millis();
+  unsigned long deadline = now + MAX_IDLE_MS;
+
+  if (_modeChanged || ledOutput.isBusy())
+    return now;
+  if (_ledEffect && isDue(_ledEffect->getNextUpdate(), deadline))
+    deadline = _ledEffect->getNextUpdate();
+  if (isDue(statusAnimation.getNextUpdate(), deadline))
+    deadline = statusAnimation.getNextUpdate();
+  return deadline;
+}
+
+// Paints the effects and sends the frame if it has changed
+void updateFrame()
+{
+  // One forced repaint per mode change. An effect which can't paint yet, e.g. the clock before
+  // the first time sync, remembers the repaint itself, so the loop doesn't force every frame.
+  bool force = _modeChanged;
+  _modeChanged = false;
+
+  {
+    LOOP_PHASE(ZONE_EFFECT);
+    if ((_ledEffect && _ledEffect->update(force)))
+    {
+      // The accents have the same layout as the base layer, so the range of the word clock also covers them
+      compositor.markDirty(LAYER_BASE, _ledEffect->getDirtyFirst(), _ledEffect->getDirtyCount());
+    }
+  }
+
+  {
+    LOOP_PHASE(ZONE_OVERLAY);
+    if (!_dormant && statusAnimation.update(force))
+    {
+      // The overlay only uses the minute LEDs
+      compositor.markDirty(LAYER_OVERLAY, FIRST_MINUTE, MINUTE_LEDS);
+    }
+  }
+
+  {
+    LOOP_PHASE(ZONE_SHOW);
+    if (isShowDue(compositor.compose()))
+    {
+      showFrame();
+    }
+    ledOutput.update();
+  }
+
+  // While the matrix is off the frame task sleeps until the next mode change
+  if (!_dormant || ledOutput.isBusy())
+    scheduler.scheduleAt(_frameTask, getNextFrame());
+}
+
+void setupTasks()
+{
+  // Frames follow the deadlines of the effects, see getNextFrame()
+  _frameTask = scheduler.add("frame", TASK_FRAME, 0, updateFrame);
+
+  if (_lightMeterOK)
+    _lightTask = scheduler.add("light", TASK_SENSOR, CHECK_LIGHT_INTERVAL, []() {
+      LOOP_PHASE(ZONE_LIGHT);
+      checkLightLevel();
+    });
+
+  _mqttTask = scheduler.add("mqtt", TASK_NETWORK, MAX_IDLE_MS, []() {
+    if (!WiFi.isConnected())
+      return;
+    LOOP_PHASE(ZONE_MQTT);
+    mqttClient.loop();
+  });
+
+  _otaTask = scheduler.add("ota", TASK_NETWORK, MAX_IDLE_MS, []() {
+    if (!WiFi.isConnected())
+      return;
+    LOOP_PHASE(ZONE_OTA);
+    ArduinoOTA.handle();
+  });
+
+  _timeTask = scheduler.add("time", TASK_NETWORK, MAX_IDLE_MS, []() {
+    if (!WiFi.isConnected())
+      return;
+    LOOP_PHASE(ZONE_TIME);
+    syncTime();
+    // Pick up a NTP reply quickly, the receive time goes into the time stamp.
+    // A short sleep instead of none keeps the loop from spinning until the reply arrives.
+    if (sntpClient.getState() == SNTP_WAITING)
+      scheduler.schedule(_timeTask, SNTP_POLL_MS);
+  });
+
+  _statsTask = scheduler.add("stats", TASK_REPORT, SEND_STATS_INTERVAL, []() {
+    if (!mqttClient.connected())
+      return;
+    LOOP_PHASE(ZONE_MQTT);
+    sendStats();
+    sendTasks();
+#ifdef PROFILING
+    sendProfile();
+#endif
+  });
+
+  _stateTask = scheduler.add("state", TASK_REPORT, SEND_LIGHT_INTERVAL, []() {
+    if (!mqttClient.connected())
+      return;
+    LOOP_PHASE(ZONE_MQTT);
+    sendBrightness();
+  });
+
+  _wifiReconnectTask = scheduler.add("wifi", TASK_NETWORK, 0, connectToWifi);
+  _mqttReconnectTask = scheduler.add("reconnect", TASK_NETWORK, 0, connectToMqtt);
+}
+
 void setup()
 {
   Serial.begin(SERIAL_SPEED);
@@ -544,11 +876,18 @@ void setup()
   _lightMeterOK = lightMeter.begin(BH1750::CONTINUOUS_LOW_RES_MODE); // Run in Low-Res mode to allow faster sampling
   DEBUG_PRINTF("BH1750 sensor %s\r\n", _lightMeterOK ? "found" : "not found");
 
+#if defined(LED_OUTPUT_DMA) || defined(LED_OUTPUT_UART)
+  // FastLED only keeps the brightness, the frames are sent by ledOutput
+  ledOutput.begin();
+#else
   FastLED.addLeds<CHIPSET, PIN_LED, COLOR_ORDER>(leds, NUM_LEDS).setCorrection(TypicalLEDStrip);
-  FastLED.setMaxPowerInVoltsAndMilliamps(5, 2000); // FastLED power management set at 5V, 2A
-  FastLED.setBrightness(BRIGHTNESS);
+  FastLED.setMaxPowerInVoltsAndMilliamps(MAX_POWER_V, MAX_POWER_MA);
   FastLED.setDither(BINARY_DITHER);
-  FastLED.clear(true);
+#endif
+  FastLED.setBrightness(BRIGHTNESS);
+  showFrame();
+
+  setupTasks();
 
   // Initialize random number generator
   setMode("Rainbow");
@@ -570,55 +909,24 @@ void setup()
   connectToWifi();
 }
 
-void loop()
+// Sleeps until the next task is due.
+// delay() hands the time to the WiFi stack, which allows the modem to sleep in between.
+void idle()
 {
-  bool update = false;
-
-  // Do it in two steps in order to always get the overlay if there is one. A simple '||' will skip the second check if the first evaluates to true
-  if ((_ledEffect && _ledEffect->paint(_modeChanged)))
-  {
-    // Reset "force" repaint flag
-    _modeChanged = false;
-    update = true;
-  }
-
-  if (statusAnimation.paint(_modeChanged))
-  {
-    update = true;
-  }
-
-  if (update)
-  {
-    FastLED.show();
-  }
+  unsigned long now = millis();
+  unsigned long deadline = scheduler.getNextDeadline();
 
-  uint64_t _millis = millis();
+  if (!isDue(deadline, now))
+    delay(deadline - now);
+}
 
-  // Check light level 20 times per second
-  if (_lightMeterOK && ((_millis - _lastLightLevelCheck >= CHECK_LIGHT_INTERVAL) || (_lastLightLevelCheck == 0)))
-  {
-    checkLightLevel();
-    _lastLightLevelCheck = _millis;
-  }
+void loop()
+{
+  // Outside of the profiled and supervised part of the loop
+  idle();
 
-  if (WiFi.isConnected())
-  {
-    mqttClient.loop();
-    if (mqttClient.connected())
-    {
-      // Send status every 60 seconds
-      if ((_millis - _lastStatsSent >= SEND_STATS_INTERVAL) || (_lastStatsSent == 0))
-      {
-        sendStats();
-        _lastStatsSent = _millis;
-      }
-      // Send state (brightness/mode) every 5 seconds
-      if ((_millis - _lastLightSent >= SEND_LIGHT_INTERVAL) || (_lastLightSent == 0))
-      {
-        sendBrightness();
-        _lastLightSent = _millis;
-      }
-    }
-    ArduinoOTA.handle();
-  }
-}
\ No newline at end of file
+  PROFILE_ZONE(ZONE_LOOP);
+  stallDetector.beginLoop();
+  scheduler.run();
+  stallDetector.endLoop();
+}
@@ -0,0 +1,189 @@
+/*
+ * The Borealis engine as it was before the fixed point rewrite, kept as a reference for the benchmark.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include "BorealisReference.h"
+
+// ---------- ReferenceWave ----------
+
+ReferenceWave::ReferenceWave(uint16_t numLeds) : _numLeds(numLeds)
+{
+  _ttl = random(500, 1501);
+  _basecolor = getWeightedColor(W_COLOR_WEIGHT_PRESET);
+  _basealpha = random(50, 101) / (float)100;
+  _age = 0;
+  _width = random(_numLeds / 10, _numLeds / W_WIDTH_FACTOR);
+  _center = random(101) / (float)100 * _numLeds;
+  _goingleft = random(0, 2) == 0;
+  _speed = random(10, 30) / (float)100 * W_SPEED_FACTOR;
+  _alive = true;
+}
+
+uint8_t ReferenceWave::getWeightedColor(uint8_t weighting)
+{
+  uint8_t sumOfWeights = 0;
+
+  for (uint8_t i = 0; i < sizeof colorweighting[0]; i++)
+  {
+    sumOfWeights += colorweighting[weighting][i];
+  }
+
+  uint8_t randomweight = random(0, sumOfWeights);
+
+  for (uint8_t i = 0; i < sizeof colorweighting[0]; i++)
+  {
+    if (randomweight < colorweighting[weighting][i])
+    {
+      return i;
+    }
+
+    randomweight -= colorweighting[weighting][i];
+  }
+  return 0;
+}
+
+CRGB *ReferenceWave::getColorForLED(int ledIndex)
+{
+  if (ledIndex < _center - _width / 2 || ledIndex > _center + _width / 2)
+  {
+    //Position out of range of this wave
+    return NULL;
+  }
+  else
+  {
+    //Offset of this led from center of wave
+    //The further away from the center, the dimmer the LED
+    int offset = abs(ledIndex - _center);
+    float offsetFactor = (float)offset / (_width / 2);
+
+    //The age of the wave determines it brightness.
+    //At half its maximum age it will be the brightest.
+    float ageFactor = 1;
+    if ((float)_age / _ttl < 0.5)
+    {
+      ageFactor = (float)_age / (_ttl / 2);
+    }
+    else
+    {
+      ageFactor = (float)(_ttl - _age) / ((float)_ttl * 0.5);
+    }
+
+    // Calculate color based on above factors and basealpha value
+    float brightness = (1 - offsetFactor) * ageFactor * _basealpha;
+    CRGB *rgb = new CRGB(allowedcolors[_basecolor]);
+    rgb->r *= brightness;
+    rgb->g *= brightness;
+    rgb->b *= brightness;
+
+    return rgb;
+  }
+}
+
+void ReferenceWave::update()
+{
+  if (_goingleft)
+  {
+    _center -= _speed;
+  }
+  else
+  {
+    _center += _speed;
+  }
+
+  _age++;
+
+  if (_age > _ttl)
+  {
+    _alive = false;
+  }
+  else
+  {
+    if (_goingleft)
+    {
+      if (_center + _width / 2 < 0)
+      {
+        _alive = false;
+      }
+    }
+    else
+    {
+      if (_center - _width / 2 > _numLeds)
+      {
+        _alive = false;
+      }
+    }
+  }
+}
+
+// ---------- ReferenceBorealis ----------
+
+ReferenceBorealis::ReferenceBorealis(CRGB *leds, uint16_t count)
+    : LedEffect(leds, count)
+{
+  randomSeed(W_RANDOM_SEED);
+  //Initial creating of waves
+  for (int i = 0; i < W_COUNT; i++)
+  {
+    waves[i] = new ReferenceWave(_numLeds);
+  }
+}
+
+ReferenceBorealis::~ReferenceBorealis()
+{
+  for (int i = 0; i < W_COUNT; i++)
+  {
+    delete waves[i];
+  }
+}
+
+bool ReferenceBorealis::paint(unsigned long elapsed, bool force)
+{
+  DrawWaves();
+  return true;
+}
+
+void ReferenceBorealis::DrawWaves()
+{
+  for (int i = 0; i < W_COUNT; i++)
+  {
+    // Update values of wave
+    waves[i]->update();
+
+    if (!(waves[i]->stillAlive()))
+    {
+      // If a wave dies, remove it from memory and spawn a new one
+      delete waves[i];
+      waves[i] = new ReferenceWave(_numLeds);
+    }
+  }
+
+  // Loop through LEDs to determine color
+  for (int i = 0; i < _numLeds; i++)
+  {
+    if (i % LED_DENSITY != 0)
+    {
+      continue;
+    }
+
+    CRGB mixedRgb = CRGB::Black;
+
+    // For each LED we must check each wave if it is "active" at this position.
+    // If there are multiple waves active on a LED we add their values.
+    for (int j = 0; j < W_COUNT; j++)
+    {
+      CRGB *rgb = waves[j]->getColorForLED(i);
+
+      if (rgb != NULL)
+      {
+        mixedRgb += *rgb;
+      }
+
+      // The original freed the color with a mismatched delete[], the allocations per hit are the same
+      delete rgb;
+    }
+    _leds[i] = mixedRgb;
+  }
+}
@@ -0,0 +1,75 @@
+/*
+ * The Borealis engine as it was before the fixed point rewrite, kept as a reference for the benchmark.
+ *
+ * Float math on every LED and wave, a heap allocated color per hit and the waves
+ * deleted and newed when they die. It draws the waves along the LED strip and is
+ * compared against the strip mode of BorealisAnimation. Not used by the firmware.
+ *
+ * The code which creates the animation is taken from:
+ * https://github.com/Mazn1191/Arduino-Borealis/blob/main/main.ino
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#pragma once
+
+#include "ArduinoBorealis.h" // W_* configuration
+
+class ReferenceWave
+{
+private:
+  //List of colors allowed for waves
+  CRGB allowedcolors[5] = {
+      CRGB(17, 177, 13),   //Greenish
+      CRGB(148, 242, 5),   //Greenish
+      CRGB(25, 173, 121),  //Turquoise
+      CRGB(250, 77, 127),  //Pink
+      CRGB(171, 101, 221), //Purple
+  };
+
+  //Colorweighing allows to give some colors more weight so it is more likely to be choosen for a wave.
+  byte colorweighting[3][5] = {
+      {10, 10, 10, 10, 10}, //Weighting equal (every color is equally likely)
+      {2, 2, 2, 6, 6},      //Weighting reddish (red colors are more likely)
+      {6, 6, 6, 2, 2}       //Weighting greenish (green colors are more likely)
+  };
+
+  uint16_t _numLeds;
+  int _ttl;
+  byte _basecolor;
+  float _basealpha;
+  int _age;
+  int _width;
+  float _center;
+  bool _goingleft;
+  float _speed;
+  bool _alive;
+
+  uint8_t getWeightedColor(uint8_t weighting);
+
+public:
+  explicit ReferenceWave(uint16_t numLeds);
+
+  CRGB *getColorForLED(int ledIndex);
+
+  //Change position and age of wave
+  //Determine if its still "alive"
+  void update();
+  bool stillAlive() { return _alive; };
+};
+
+class ReferenceBorealis : public LedEffect
+{
+private:
+  ReferenceWave *waves[W_COUNT];
+
+  void DrawWaves();
+
+public:
+  explicit ReferenceBorealis(CRGB *leds, uint16_t count);
+  ~ReferenceBorealis();
+
+  // One step of the waves per painted frame, like the original
+  bool paint(unsigned long elapsed, bool force) override;
+};
@@ -0,0 +1,187 @@
+/*
+ * Host benchmark for the LED effects.
+ *
+ * Runs every effect for a fixed number of frames against the native shim
+ * and reports the time and the number of heap allocations per frame.
+ * The simulated clock advances by UPDATE_MS per frame, just like the main loop on the device.
+ * The Borealis engine from before the fixed point rewrite runs as a reference case
+ * next to the strip mode of the current one, see BorealisReference.h.
+ * Then the color lookups are timed per pixel, with and without the color cache.
+ *
+ * Build and run with:
+ *   pio run -e native && .pio/build/native/program [frames]
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <new>
+
+#include "WordClock.h"
+#include "StatusAnimation.h"
+#include "SnakeAnimation.h"
+#include "RainbowAnimation.h"
+#include "ArduinoBorealis.h"
+#include "MatrixAnimation.h"
+#include "MoodLight.h"
+#include "BorealisReference.h"
+
+#define MATRIX_WIDTH 11
+#define MATRIX_HEIGHT 10
+#define NUM_LEDS (MATRIX_WIDTH * MATRIX_HEIGHT) + MINUTE_LEDS + SECOND_LEDS
+
+#define DEFAULT_FRAMES 20000
+
+// ---------- Allocation counting ----------
+
+static unsigned long _allocations = 0;
+
+void *operator new(size_t size)
+{
+  _allocations++;
+  void *p = malloc(size);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+  free(p);
+}
+
+// ---------- Fixture ----------
+
+CRGB leds_plus_safety_pixel[NUM_LEDS + 1];
+CRGB *const leds(leds_plus_safety_pixel + 1);
+
+StaticLedMatrix<MATRIX_WIDTH, MATRIX_HEIGHT> ledMatrix;
+
+// Simulated wall clock which starts at 09:58:00 and runs with millis()
+bool onGetTime(int &hours, int &minutes, int &seconds, int &milliseconds)
+{
+  unsigned long t = (9 * 3600UL + 58 * 60UL) + millis() / 1000UL;
+
+  hours = (t / 3600) % 24;
+  minutes = (t / 60) % 60;
+  seconds = t % 60;
+  milliseconds = millis() % 1000UL;
+  return true;
+}
+
+void runBenchmark(const char *name, LedEffect *effect, unsigned long frames)
+{
+  nativeSetMillis(0);
+  memset8(leds, 0, sizeof(CRGB) * NUM_LEDS);
+  effect->init();
+  effect->update(true);
+
+  unsigned long allocations = _allocations;
+  auto start = std::chrono::steady_clock::now();
+
+  for (unsigned long i = 0; i < frames; i++)
+  {
+    nativeAdvanceMillis(UPDATE_MS);
+    if (effect->update(false))
+      FastLED.show();
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  allocations = _allocations - allocations;
+
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  printf("%-20s %12.1f %14.2f\r\n", name, ns / frames, (double)allocations / frames);
+}
+
+// Times one color lookup per pixel for frames * NUM_LEDS pixels.
+// The colors are summed up, so the compiler can't drop the lookups.
+template <typename TLookup>
+void runColorBenchmark(const char *name, unsigned long frames, TLookup lookup)
+{
+  unsigned long pixels = frames * NUM_LEDS;
+  uint32_t sum = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < pixels; i++)
+  {
+    CRGB color = lookup((uint8_t)(i * 7), (uint8_t)(i >> 3));
+    sum += color.r + color.g + color.b;
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  printf("%-28s %12.2f %10u\r\n", name, ns / pixels, (unsigned)(sum & 0xFFFF));
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned long frames = DEFAULT_FRAMES;
+  if (argc > 1)
+    frames = strtoul(argv[1], nullptr, 10);
+  if (frames == 0)
+    frames = DEFAULT_FRAMES;
+
+  FastLED.addLeds(leds, NUM_LEDS);
+
+  WordClock wordClock(&ledMatrix, leds, leds, NUM_LEDS, onGetTime);
+  BorealisAnimation borealisAnimation(&ledMatrix, leds, NUM_LEDS);
+  BorealisAnimation borealisStrip(&ledMatrix, leds, NUM_LEDS);
+  borealisStrip.setCurtains(false);
+  ReferenceBorealis borealisReference(leds, NUM_LEDS);
+  MatrixAnimation matrixAnimation(&ledMatrix, leds, NUM_LEDS);
+  RainbowAnimation rainbowAnimation(&ledMatrix, leds, NUM_LEDS);
+  SnakeAnimation snakeAnimation(&ledMatrix, leds, NUM_LEDS);
+  StatusAnimation statusAnimation(&ledMatrix, leds, NUM_LEDS);
+  MoodLight moodLight(&ledMatrix, leds, NUM_LEDS);
+
+  // The status overlay is only animated while there is no connection
+  statusAnimation.setStatus(CLOCK_STATUS::WIFI_DISCONNECTED);
+
+  printf("%lu frames, %d ms per frame\r\n\r\n", frames, UPDATE_MS);
+  printf("%-20s %12s %14s\r\n", "effect", "ns/frame", "allocs/frame");
+
+  runBenchmark("WordClock", &wordClock, frames);
+  runBenchmark("BorealisAnimation", &borealisAnimation, frames);
+  runBenchmark("Borealis (strip)", &borealisStrip, frames);
+  runBenchmark("Borealis (reference)", &borealisReference, frames);
+  runBenchmark("MatrixAnimation", &matrixAnimation, frames);
+  runBenchmark("RainbowAnimation", &rainbowAnimation, frames);
+  runBenchmark("SnakeAnimation", &snakeAnimation, frames);
+  runBenchmark("StatusAnimation", &statusAnimation, frames);
+  runBenchmark("MoodLight", &moodLight, frames);
+
+  CRGBPalette16 palette(LavaColors_p);
+  uint32_t paletteKey = colorCache.createKey();
+
+  printf("\r\n%-28s %12s %10s\r\n", "color lookup", "ns/pixel", "checksum");
+  runColorBenchmark("ColorFromPalette", frames, [&](uint8_t index, uint8_t value) { return ColorFromPalette(palette, index); });
+  runColorBenchmark("palette cache", frames, [&](uint8_t index, uint8_t value) { return colorCache.getPalette(palette, paletteKey)[index]; });
+  runColorBenchmark("CHSV(hue, 255, 255)", frames, [](uint8_t hue, uint8_t value) { return CRGB(CHSV(hue, 255, 255)); });
+  runColorBenchmark("hue table", frames, [](uint8_t hue, uint8_t value) { return colorCache.getHues()[hue]; });
+  runColorBenchmark("CHSV(hue, 255, value)", frames, [](uint8_t hue, uint8_t value) { return CRGB(CHSV(hue, 255, value)); });
+  runColorBenchmark("hue table, scaled", frames, [](uint8_t hue, uint8_t value) { return colorCache.getHue(hue, value); });
+
+  return 0;
+}
@@ -0,0 +1,364 @@
+/*
+ * Accelerated time simulator for the word clock.
+ *
+ * Runs WordClock against a fake time source and fast-forwards through a full day,
+ * once with "quarter past/quarter to" and once with "quarter/three quarters".
+ * After every displayed minute the lit pixels of the matrix and the minute LEDs are
+ * written as one trace line:
+ *
+ *   HHMM <matrix bits, top row first, as hex> <minute LED bits as hex>
+ *
+ * The traces are compared against the golden traces of the selected layout in tools/clocksim/golden/<layout>.
+ * Mismatching minutes are printed as a matrix of expected/actual pixels.
+ * Select another layout with PLATFORMIO_BUILD_FLAGS="-D WORD_LAYOUT_<NAME>".
+ *
+ * Build and run with:
+ *   pio run -e native_clocksim && .pio/build/native_clocksim/program [--update] [golden dir]
+ *
+ * --update rewrites the golden traces from the current rendering.
+ *
+ * Before the sweeps a few frames are composed from a base layer and an overlay,
+ * and the output pixels and the changed flag of compose() are checked.
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "WordClock.h"
+#include "Compositor.h"
+#include "LedOutput.h"
+#include "layouts/WordLayout.h"
+
+#define MATRIX_WIDTH 11
+#define MATRIX_HEIGHT 10
+#define NUM_LEDS (MATRIX_WIDTH * MATRIX_HEIGHT) + MINUTE_LEDS + SECOND_LEDS
+
+#define FIRST_MINUTE_LED (MATRIX_WIDTH * MATRIX_HEIGHT)
+
+#define SECONDS_PER_DAY 86400UL
+#define STEP_MS 1000UL // The display shows nothing finer than seconds
+#define MAX_REPORTED_MISMATCHES 5
+
+CRGB leds_plus_safety_pixel[NUM_LEDS + 1];
+CRGB *const leds(leds_plus_safety_pixel + 1);
+
+StaticLedMatrix<MATRIX_WIDTH, MATRIX_HEIGHT> ledMatrix;
+CaptureLedOutput ledOutput;
+
+// Simulated seconds since midnight, set by the sweep
+static unsigned long _simTime = 0;
+
+bool onGetTime(int &hours, int &minutes, int &seconds, int &milliseconds)
+{
+  hours = (_simTime / 3600) % 24;
+  minutes = (_simTime / 60) % 60;
+  seconds = _simTime % 60;
+  milliseconds = 0; // The sweep moves from second boundary to second boundary
+  return true;
+}
+
+// Trace of the last frame that was sent to the output
+std::string traceLine(unsigned long t)
+{
+  const CRGB *frame = ledOutput.getFrame();
+  char buffer[16];
+  std::string line;
+
+  snprintf(buffer, sizeof(buffer), "%02lu%02lu ", (t / 3600) % 24, (t / 60) % 60);
+  line = buffer;
+
+  uint8_t nibble = 0;
+  uint8_t bits = 0;
+  for (int y = MATRIX_HEIGHT - 1; y >= 0; y--)
+  {
+    for (uint8_t x = 0; x < MATRIX_WIDTH; x++)
+    {
+      nibble = (nibble << 1) | (frame[ledMatrix.xy(x, y)] ? 1 : 0);
+      if (++bits == 4)
+      {
+        line += "0123456789abcdef"[nibble];
+        nibble = bits = 0;
+      }
+    }
+  }
+  if (bits > 0)
+    line += "0123456789abcdef"[nibble << (4 - bits)];
+
+  line += ' ';
+  nibble = 0;
+  for (uint8_t i = 0; i < MINUTE_LEDS; i++)
+    nibble |= (frame[FIRST_MINUTE_LED + i] ? 1 : 0) << i;
+  snprintf(buffer, sizeof(buffer), "%x", nibble);
+  line += buffer;
+
+  return line;
+}
+
+// Renders one day and returns one trace line per minute
+std::vector<std::string> sweep(WordClock &wordClock, double &renderNs, unsigned long &paints)
+{
+  std::vector<std::string> trace;
+  trace.reserve(SECONDS_PER_DAY / 60);
+
+  nativeSetMillis(0);
+  memset8(leds, 0, sizeof(CRGB) * NUM_LEDS);
+  _simTime = 0;
+  wordClock.init();
+  wordClock.update(true);
+
+  auto rendering = std::chrono::steady_clock::duration::zero();
+
+  for (unsigned long ms = 0; ms < SECONDS_PER_DAY * 1000UL; ms += STEP_MS)
+  {
+    _simTime = ms / 1000UL;
+    nativeSetMillis(ms + STEP_MS);
+
+    auto before = std::chrono::steady_clock::now();
+    wordClock.update(false);
+    rendering += std::chrono::steady_clock::now() - before;
+    paints++;
+
+    // Sample the frame once at the end of every displayed minute
+    if ((ms + STEP_MS) % 60000UL == 0)
+    {
+      ledOutput.submit(leds, NUM_LEDS, 255);
+      trace.push_back(traceLine(_simTime));
+    }
+  }
+
+  renderNs += std::chrono::duration<double, std::nano>(rendering).count();
+  return trace;
+}
+
+bool readTrace(const std::string &fileName, std::vector<std::string> &trace)
+{
+  FILE *f = fopen(fileName.c_str(), "r");
+  if (!f)
+    return false;
+
+  char buffer[128];
+  while (fgets(buffer, sizeof(buffer), f))
+  {
+    std::string line(buffer);
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+      line.pop_back();
+    if (!line.empty())
+      trace.push_back(line);
+  }
+  fclose(f);
+  return true;
+}
+
+bool writeTrace(const std::string &fileName, const std::vector<std::string> &trace)
+{
+  FILE *f = fopen(fileName.c_str(), "w");
+  if (!f)
+    return false;
+
+  for (const std::string &line : trace)
+    fprintf(f, "%s\n", line.c_str());
+  fclose(f);
+  return true;
+}
+
+uint8_t hexValue(char c)
+{
+  return (c <= '9') ? c - '0' : c - 'a' + 10;
+}
+
+bool pixelAt(const std::string &line, uint8_t index)
+{
+  // Matrix bits start after "HHMM "
+  return (hexValue(line[5 + index / 4]) >> (3 - index % 4)) & 0x01;
+}
+
+// Prints expected and actual matrix on top of each other.
+// Letter = lit in both, '.' = dark in both, '+' = only lit in actual, '-' = only lit in expected
+void printMismatch(const std::string &expected, const std::string &actual)
+{
+  printf("  expected: %s\r\n  actual:   %s\r\n", expected.c_str(), actual.c_str());
+  for (uint8_t y = 0; y < MATRIX_HEIGHT; y++)
+  {
+    const char *letter = (y < LAYOUT_HEIGHT) ? LAYOUT_GRID[y] : "";
+
+    printf("  ");
+    for (uint8_t x = 0; x < MATRIX_WIDTH; x++)
+    {
+      // The grid is UTF-8, a letter may take more than one byte
+      const char *next = letter;
+      if (*next)
+        while ((*++next & 0xC0) == 0x80)
+          ;
+
+      uint8_t index = y * MATRIX_WIDTH + x;
+      bool e = pixelAt(expected, index);
+      bool a = pixelAt(actual, index);
+      if (e && a && (next > letter))
+        printf("%.*s", (int)(next - letter), letter);
+      else
+        putchar(e && a ? '#' : (a ? '+' : (e ? '-' : '.')));
+      letter = next;
+    }
+    printf("\r\n");
+  }
+}
+
+int compareTrace(const char *name, const std::vector<std::string> &expected, const std::vector<std::string> &actual)
+{
+  int mismatches = 0;
+
+  if (expected.size() != actual.size())
+  {
+    printf("%s: expected %zu minutes, got %zu\r\n", name, expected.size(), actual.size());
+    return 1;
+  }
+
+  for (size_t i = 0; i < expected.size(); i++)
+  {
+    if (expected[i] != actual[i])
+    {
+      if (mismatches < MAX_REPORTED_MISMATCHES)
+      {
+        printf("%s: mismatch at %s\r\n", name, expected[i].substr(0, 4).c_str());
+        printMismatch(expected[i], actual[i]);
+      }
+      mismatches++;
+    }
+  }
+
+  printf("%s: %zu minutes, %d mismatches\r\n", name, expected.size(), mismatches);
+  return mismatches;
+}
+
+// ---------- Compositor ----------
+
+#define COMPOSITOR_LEDS 8
+
+static int _compositorFailures = 0;
+
+static void expect(bool condition, const char *what)
+{
+  if (!condition)
+  {
+    printf("compositor: %s failed\r\n", what);
+    _compositorFailures++;
+  }
+}
+
+// Composes a base layer and an overlay into a small output buffer
+int checkCompositor()
+{
+  CRGB output[COMPOSITOR_LEDS];
+  memset8(output, 0, sizeof(output));
+
+  // On the heap, so the layers don't start out zero initialized like a global
+  Compositor *compositor = new Compositor(output, COMPOSITOR_LEDS);
+  CRGB *base = compositor->getLayer(LAYER_BASE);
+  CRGB *overlay = compositor->getLayer(LAYER_OVERLAY);
+
+  expect(!compositor->compose(), "black first frame is unchanged");
+
+  base[2] = CRGB::Red;
+  base[3] = CRGB::Green;
+  compositor->markDirty(LAYER_BASE, 2, 2);
+  expect(compositor->compose(), "base layer changes the frame");
+  expect((output[2] == CRGB(CRGB::Red)) && (output[3] == CRGB(CRGB::Green)), "base layer pixels");
+
+  overlay[2] = CRGB::Blue;
+  compositor->markDirty(LAYER_OVERLAY, 2, 2);
+  expect(compositor->compose(), "overlay changes the frame");
+  expect(output[2] == CRGB(CRGB::Blue), "lit overlay pixel replaces the base");
+  expect(output[3] == CRGB(CRGB::Green), "black overlay pixel is transparent");
+
+  compositor->markDirty(LAYER_BASE);
+  expect(!compositor->compose(), "repainted frame with the same pixels is unchanged");
+
+  base[5] = CRGB::White;
+  expect(!compositor->compose(), "frame without dirty layers is unchanged");
+  expect(!output[5], "pixels outside of the dirty range are not blended");
+
+  compositor->setBlendMode(LAYER_OVERLAY, BLEND_ADD);
+  expect(compositor->compose(), "blend mode change recomposes the frame");
+  expect(output[2] == CRGB(255, 0, 255), "added overlay pixel");
+  expect(output[5] == CRGB(CRGB::White), "blend mode change recomposes the whole layer");
+
+  compositor->clear(LAYER_OVERLAY);
+  expect(compositor->compose(), "cleared overlay changes the frame");
+  expect(output[2] == CRGB(CRGB::Red), "cleared overlay shows the base");
+
+  delete compositor;
+
+  printf("compositor: %d failures\r\n\r\n", _compositorFailures);
+  return _compositorFailures;
+}
+
+int main(int argc, char *argv[])
+{
+  bool update = false;
+  std::string goldenDir = "tools/clocksim/golden/" LAYOUT_NAME;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--update") == 0)
+      update = true;
+    else
+      goldenDir = argv[i];
+  }
+
+  printf("Layout %s\r\n", LAYOUT_NAME);
+
+  FastLED.addLeds(leds, NUM_LEDS);
+  WordClock wordClock(&ledMatrix, leds, leds, NUM_LEDS, onGetTime);
+
+  struct
+  {
+    const char *name;
+    bool useThreeQuarters;
+  } modes[] = {
+      {"quarter_past", false},
+      {"three_quarters", true}};
+
+  double renderNs = 0;
+  unsigned long paints = 0;
+  int failures = checkCompositor();
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (auto &mode : modes)
+  {
+    wordClock.setUseThreeQuarters(mode.useThreeQuarters);
+    std::vector<std::string> actual = sweep(wordClock, renderNs, paints);
+    std::string fileName = goldenDir + "/" + mode.name + ".trace";
+
+    if (update)
+    {
+      if (!writeTrace(fileName, actual))
+      {
+        printf("%s: cannot write %s\r\n", mode.name, fileName.c_str());
+        failures++;
+      }
+      else
+        printf("%s: wrote %zu minutes to %s\r\n", mode.name, actual.size(), fileName.c_str());
+      continue;
+    }
+
+    std::vector<std::string> expected;
+    if (!readTrace(fileName, expected))
+    {
+      printf("%s: cannot read %s\r\n", mode.name, fileName.c_str());
+      failures++;
+      continue;
+    }
+    failures += compareTrace(mode.name, expected, actual);
+  }
+
+  double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  printf("\r\n%lu paints, render %.1f ms (%.1f ns/paint), total %.1f ms\r\n",
+         paints, renderNs / 1e6, renderNs / paints, totalMs);
+
+  return failures == 0 ? 0 : 1;
+}
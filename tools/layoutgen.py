@@ -0,0 +1,276 @@
+#!/usr/bin/env python3
+#
+# Word layout generator.
+#
+# Compiles the layout descriptions in layouts/*.layout into C++ headers in src/layouts.
+# Each header contains the word positions, the word texts, the letter grid and the
+# time -> words table as PROGMEM tables. src/layouts/WordLayout.h selects one layout
+# per build with -D WORD_LAYOUT_<NAME>, the other layouts are not compiled in.
+#
+# Runs as a PlatformIO pre script before every build and only rewrites headers whose
+# content has changed. It can also be run by hand:
+#   python3 tools/layoutgen.py
+#
+# Version: 1.0
+# Author: Lübbe Onken (http://github.com/luebbe)
+
+import glob
+import os
+import re
+import sys
+
+DEFAULT_LAYOUT = "de"
+MAX_WORDS = 32  # One bit per word in the word mask
+SLOTS = 12      # Five minute slots per hour
+HOURS = 12
+
+
+class LayoutError(Exception):
+    pass
+
+
+class Layout:
+    def __init__(self, fileName):
+        self.fileName = fileName
+        self.name = None
+        self.width = 0
+        self.height = 0
+        self.grid = []
+        self.words = []  # (name, x, y, len)
+        self.always = []
+        self.hours = []
+        self.fullHours = {}  # hour -> word
+        self.slots = [None] * SLOTS
+        self.threeQuarters = [None] * SLOTS
+
+    def error(self, lineNo, message):
+        raise LayoutError("%s:%d: %s" % (self.fileName, lineNo, message))
+
+    def wordIndex(self, lineNo, name):
+        for i, word in enumerate(self.words):
+            if word[0] == name:
+                return i
+        self.error(lineNo, "unknown word '%s'" % name)
+
+    def parseWords(self, lineNo, names):
+        offset = 0
+        words = []
+        for name in names:
+            if name == "+1":
+                offset = 1
+            else:
+                words.append(self.wordIndex(lineNo, name))
+        return (offset, words)
+
+    def parse(self):
+        section = None
+        with open(self.fileName, encoding="utf-8") as f:
+            lines = f.read().splitlines()
+
+        for lineNo, line in enumerate(lines, 1):
+            line = line.split("#", 1)[0].rstrip()
+            if not line:
+                continue
+
+            key, sep, value = line.partition(":")
+            key = key.strip()
+            fields = value.split()
+
+            if sep and key in ("grid", "words"):
+                section = key
+            elif sep and key == "name":
+                section = None
+                self.name = value.strip()
+                if not re.match(r"^[a-z][a-z0-9_]*$", self.name):
+                    self.error(lineNo, "invalid layout name '%s'" % self.name)
+            elif sep and key == "size":
+                section = None
+                self.width, self.height = int(fields[0]), int(fields[1])
+            elif sep and key == "always":
+                section = None
+                self.always = self.parseWords(lineNo, fields)[1]
+            elif sep and key == "hours":
+                section = None
+                if len(fields) != HOURS:
+                    self.error(lineNo, "expected %d hour words" % HOURS)
+                self.hours = self.parseWords(lineNo, fields)[1]
+            elif sep and key.startswith("fullhour"):
+                section = None
+                self.fullHours[int(key.split()[1]) % HOURS] = self.wordIndex(lineNo, value.strip())
+            elif sep and key.startswith("slot"):
+                section = None
+                args = key.split()
+                slot = int(args[1])
+                if slot < 0 or slot >= SLOTS:
+                    self.error(lineNo, "slot out of range")
+                if len(args) > 2 and args[2] == "threequarters":
+                    self.threeQuarters[slot] = self.parseWords(lineNo, fields)
+                else:
+                    self.slots[slot] = self.parseWords(lineNo, fields)
+            elif section == "grid":
+                if len(line.strip()) != self.width:
+                    self.error(lineNo, "grid row must have %d letters" % self.width)
+                self.grid.append(line.strip())
+            elif section == "words":
+                fields = line.split()
+                if len(fields) != 4:
+                    self.error(lineNo, "expected: name x y length")
+                name, x, y, length = fields[0], int(fields[1]), int(fields[2]), int(fields[3])
+                if x < 0 or y < 0 or length < 1 or x + length > self.width or y >= self.height:
+                    self.error(lineNo, "word '%s' is outside of the grid" % name)
+                self.words.append((name, x, y, length))
+            else:
+                self.error(lineNo, "unexpected line '%s'" % line)
+
+        if not self.name:
+            self.error(0, "missing name")
+        if len(self.grid) != self.height:
+            self.error(0, "grid must have %d rows" % self.height)
+        if len(self.words) > MAX_WORDS:
+            self.error(0, "more than %d words" % MAX_WORDS)
+        if len(self.hours) != HOURS:
+            self.error(0, "missing hours")
+        for slot in range(SLOTS):
+            if self.slots[slot] is None:
+                self.error(0, "missing slot %d" % slot)
+
+    def text(self, word):
+        name, x, y, length = word
+        return self.grid[self.height - 1 - y][x:x + length]
+
+    def timeWords(self, threeQuarters, slot, hour):
+        offset, words = self.slots[slot]
+        if threeQuarters and self.threeQuarters[slot] is not None:
+            offset, words = self.threeQuarters[slot]
+
+        hour = (hour + offset) % HOURS
+        mask = 0
+        for word in self.always + words:
+            mask |= 1 << word
+        if slot == 0 and hour in self.fullHours:
+            mask |= 1 << self.fullHours[hour]
+        else:
+            mask |= 1 << self.hours[hour]
+        return mask
+
+    def generate(self):
+        source = os.path.relpath(self.fileName, projectDir).replace(os.sep, "/")
+        out = []
+        out.append("/*")
+        out.append(" * Word layout \"%s\", generated by tools/layoutgen.py from %s." % (self.name, source))
+        out.append(" * Don't edit, change the layout file instead.")
+        out.append(" */")
+        out.append("")
+        out.append("#pragma once")
+        out.append("")
+        out.append("#define LAYOUT_NAME \"%s\"" % self.name)
+        out.append("#define LAYOUT_WIDTH %d" % self.width)
+        out.append("#define LAYOUT_HEIGHT %d" % self.height)
+        out.append("#define LAYOUT_WORD_COUNT %d" % len(self.words))
+        out.append("")
+
+        out.append("// Word positions with 0,0 at the bottom left")
+        out.append("static const TLAYOUTWORD LAYOUT_WORDS[LAYOUT_WORD_COUNT] PROGMEM = {")
+        out.append("    // x, y, length")
+        for word in self.words:
+            out.append("    {%d, %d, %d}, // %s" % (word[1], word[2], word[3], word[0]))
+        out.append("};")
+        out.append("")
+
+        out.append("// Word texts as they appear on the face")
+        for i, word in enumerate(self.words):
+            out.append("static const char LAYOUT_TEXT_%d[] PROGMEM = \"%s\";" % (i, self.text(word)))
+        out.append("static const char *const LAYOUT_TEXTS[LAYOUT_WORD_COUNT] PROGMEM = {")
+        out.append("    " + ", ".join("LAYOUT_TEXT_%d" % i for i in range(len(self.words))) + "};")
+        out.append("")
+
+        out.append("// Letter grid in UTF-8, top row first")
+        for y, row in enumerate(self.grid):
+            out.append("static const char LAYOUT_ROW_%d[] PROGMEM = \"%s\";" % (y, row))
+        out.append("static const char *const LAYOUT_GRID[LAYOUT_HEIGHT] PROGMEM = {")
+        out.append("    " + ", ".join("LAYOUT_ROW_%d" % y for y in range(self.height)) + "};")
+        out.append("")
+
+        out.append("// Words for each time, indexed by [threeQuarters][5 minute slot][hour % 12].")
+        out.append("// One bit per LAYOUT_WORDS entry.")
+        out.append("static const uint32_t LAYOUT_TIME_WORDS[2][12][12] PROGMEM = {")
+        for threeQuarters in range(2):
+            out.append("    {")
+            for slot in range(SLOTS):
+                masks = ", ".join("0x%08x" % self.timeWords(threeQuarters == 1, slot, hour) for hour in range(HOURS))
+                out.append("        {%s}, // :%02d" % (masks, slot * 5))
+            out.append("    },")
+        out.append("};")
+        out.append("")
+        return "\n".join(out)
+
+
+def selectionHeader(layouts):
+    out = []
+    out.append("/*")
+    out.append(" * Word layout selection, generated by tools/layoutgen.py.")
+    out.append(" * Don't edit, add a layout file to layouts/ instead.")
+    out.append(" *")
+    out.append(" * Select a layout with -D WORD_LAYOUT_<NAME>, the default is \"%s\"." % DEFAULT_LAYOUT)
+    out.append(" * Include this file in one translation unit only, every inclusion adds a copy of the tables to flash.")
+    out.append(" */")
+    out.append("")
+    out.append("#pragma once")
+    out.append("")
+    out.append("#include \"Arduino.h\"")
+    out.append("")
+    out.append("struct TLAYOUTWORD")
+    out.append("{")
+    out.append("  uint8_t x;")
+    out.append("  uint8_t y;")
+    out.append("  uint8_t len;")
+    out.append("};")
+    out.append("")
+    for i, layout in enumerate(layouts):
+        out.append("#%s defined(WORD_LAYOUT_%s)" % ("if" if i == 0 else "elif", layout.name.upper()))
+        out.append("#include \"Layout_%s.h\"" % layout.name)
+    out.append("#else")
+    out.append("#include \"Layout_%s.h\"" % DEFAULT_LAYOUT)
+    out.append("#endif")
+    out.append("")
+    return "\n".join(out)
+
+
+def writeIfChanged(fileName, content):
+    if os.path.exists(fileName):
+        with open(fileName, encoding="utf-8") as f:
+            if f.read() == content:
+                return
+    with open(fileName, "w", encoding="utf-8") as f:
+        f.write(content)
+    print("layoutgen: wrote %s" % os.path.relpath(fileName, projectDir))
+
+
+def run():
+    layouts = []
+    for fileName in sorted(glob.glob(os.path.join(projectDir, "layouts", "*.layout"))):
+        layout = Layout(fileName)
+        layout.parse()
+        layouts.append(layout)
+
+    if DEFAULT_LAYOUT not in [layout.name for layout in layouts]:
+        raise LayoutError("default layout '%s' is missing" % DEFAULT_LAYOUT)
+
+    outDir = os.path.join(projectDir, "src", "layouts")
+    os.makedirs(outDir, exist_ok=True)
+    for layout in layouts:
+        writeIfChanged(os.path.join(outDir, "Layout_%s.h" % layout.name), layout.generate())
+    writeIfChanged(os.path.join(outDir, "WordLayout.h"), selectionHeader(layouts))
+
+
+try:
+    Import("env")  # noqa: F821, only defined when running as PlatformIO script
+    projectDir = env["PROJECT_DIR"]  # noqa: F821
+except NameError:
+    projectDir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+try:
+    run()
+except LayoutError as e:
+    print("layoutgen: error: %s" % e)
+    sys.exit(1)
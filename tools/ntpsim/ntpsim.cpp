@@ -0,0 +1,263 @@
+/*
+ * Time sync simulator with a local stand-in for the NTP servers.
+ *
+ * NtpStandIn implements the UDP interface and answers the requests of SntpClient
+ * as a set of simulated servers, each with its own offset, network delay, jitter,
+ * packet loss and outliers. millis() runs slow by a fixed drift against the true
+ * time. Every scenario runs SntpClient and LocalTime for a few simulated days and
+ * checks the error of the clock after the first day against a limit, and that
+ * the clock never jumped by more than CLOCK_FILTER_SPIKE_MS at once.
+ *
+ * Build and run with:
+ *   pio run -e native_ntpsim && .pio/build/native_ntpsim/program
+ *
+ * Version: 1.0
+ * Author: Lübbe Onken (http://github.com/luebbe)
+ */
+
+#include <cstdio>
+#include <random>
+
+#include "LocalTime.h"
+#include "SntpClient.h"
+
+#define NTP_UNIX_OFFSET 2208988800ULL
+#define SIM_DAYS 3
+#define SIM_START_UTC 1792890000ULL // Some day in 2026
+#define SETTLE_MS (86400UL * 1000UL)
+#define STEP_IDLE_MS 100UL
+#define CHECK_MS 1000UL
+
+struct TStandInServer
+{
+  const char *address;
+  int32_t offsetMs;     // Error of the server
+  uint16_t delayMs;     // Round trip time of the network ...
+  uint16_t jitterMs;    // ... plus up to this much in each direction
+  uint8_t lossPercent;  // Requests or replies that get lost
+  uint8_t spikePercent; // Replies which are off by spikeMs
+  int32_t spikeMs;
+};
+
+struct TScenario
+{
+  const char *name;
+  double driftPpm; // millis() is slow by this much
+  TStandInServer servers[SNTP_MAX_SERVERS];
+  uint8_t serverCount;
+  uint32_t maxErrorMs;
+};
+
+static const TScenario SCENARIOS[] = {
+    {"lan and pool", 40, {{"192.168.0.1", 0, 1, 1, 0, 0, 0}, {"10.0.0.1", 3, 30, 20, 2, 0, 0}, {"10.0.0.2", -2, 45, 30, 2, 0, 0}, {"10.0.0.3", 0, 25, 15, 2, 0, 0}}, 4, 10},
+    {"pool only", -25, {{"10.0.0.1", 3, 30, 20, 2, 0, 0}, {"10.0.0.2", -2, 45, 30, 2, 0, 0}, {"10.0.0.3", 0, 25, 15, 2, 0, 0}}, 3, 50},
+    {"falseticker", 40, {{"10.0.0.1", 2500, 5, 2, 0, 0, 0}, {"10.0.0.2", 0, 30, 20, 0, 0, 0}, {"10.0.0.3", 1, 35, 20, 0, 0, 0}}, 3, 50},
+    {"spikes", 60, {{"10.0.0.1", 0, 20, 10, 0, 10, 800}}, 1, 50},
+    {"lossy, lan down", 40, {{"192.168.0.1", 0, 1, 1, 100, 0, 0}, {"10.0.0.1", 0, 30, 20, 30, 0, 0}, {"10.0.0.2", 0, 40, 20, 30, 0, 0}}, 3, 50},
+};
+
+static void writeTimestamp(uint8_t *buffer, double utcMs)
+{
+  uint64_t ntp = (uint64_t)((utcMs / 1000.0 + NTP_UNIX_OFFSET) * 4294967296.0);
+  for (uint8_t i = 0; i < 8; i++)
+    buffer[i] = ntp >> (56 - 8 * i);
+}
+
+class NtpStandIn : public UDP
+{
+private:
+  struct TPacket
+  {
+    unsigned long arrival; // millis() at which the packet arrives
+    IPAddress from;
+    uint8_t data[SNTP_PACKET_SIZE];
+  };
+
+  const TScenario &_scenario;
+  std::mt19937 _rng;
+  std::vector<TPacket> _inbox;
+  TPacket _current;
+  bool _hasCurrent;
+  IPAddress _destination;
+  uint8_t _request[SNTP_PACKET_SIZE];
+  size_t _requestSize;
+
+  double random(double range) { return std::uniform_real_distribution<double>(0, range)(_rng); }
+  bool chance(uint8_t percent) { return random(100) < percent; }
+
+public:
+  unsigned long requests = 0;
+
+  NtpStandIn(const TScenario &scenario) : _scenario(scenario), _rng(1), _hasCurrent(false), _requestSize(0) {}
+
+  // True time in ms since 1970 at the given millis()
+  double getTrueMs(unsigned long atMillis) const
+  {
+    return SIM_START_UTC * 1000.0 + atMillis * (1.0 + _scenario.driftPpm / 1e6);
+  }
+
+  uint8_t begin(uint16_t port) override { return 1; }
+  void stop() override { _inbox.clear(); }
+
+  int beginPacket(IPAddress ip, uint16_t port) override
+  {
+    _destination = ip;
+    _requestSize = 0;
+    return 1;
+  }
+
+  size_t write(const uint8_t *buffer, size_t size) override
+  {
+    size = min(size, sizeof(_request) - _requestSize);
+    memcpy(&_request[_requestSize], buffer, size);
+    _requestSize += size;
+    return size;
+  }
+
+  // Answers the request as the addressed server would
+  int endPacket() override
+  {
+    requests++;
+    for (uint8_t i = 0; i < _scenario.serverCount; i++)
+    {
+      const TStandInServer &server = _scenario.servers[i];
+      IPAddress ip;
+      ip.fromString(server.address);
+      if ((ip != _destination) || (_requestSize != SNTP_PACKET_SIZE) || chance(server.lossPercent))
+        continue;
+
+      double there = server.delayMs / 2.0 + random(server.jitterMs);
+      double back = server.delayMs / 2.0 + random(server.jitterMs);
+      double serverMs = getTrueMs(millis()) + there + server.offsetMs;
+      if (chance(server.spikePercent))
+        serverMs += server.spikeMs;
+
+      TPacket reply;
+      memset(reply.data, 0, SNTP_PACKET_SIZE);
+      reply.data[0] = 0x24; // No leap second warning, version 4, server mode
+      reply.data[1] = 2;    // Stratum
+      memcpy(&reply.data[24], &_request[40], 8);
+      writeTimestamp(&reply.data[32], serverMs);
+      writeTimestamp(&reply.data[40], serverMs + 1);
+      reply.from = ip;
+      reply.arrival = millis() + (unsigned long)(there + 1 + back);
+      _inbox.push_back(reply);
+    }
+    return 1;
+  }
+
+  int parsePacket() override
+  {
+    _hasCurrent = false;
+    for (size_t i = 0; i < _inbox.size(); i++)
+    {
+      if ((long)(millis() - _inbox[i].arrival) >= 0)
+      {
+        _current = _inbox[i];
+        _inbox.erase(_inbox.begin() + i);
+        _hasCurrent = true;
+        return SNTP_PACKET_SIZE;
+      }
+    }
+    return 0;
+  }
+
+  int read(uint8_t *buffer, size_t len) override
+  {
+    if (!_hasCurrent)
+      return 0;
+    len = min(len, (size_t)SNTP_PACKET_SIZE);
+    memcpy(buffer, _current.data, len);
+    _hasCurrent = false;
+    return len;
+  }
+
+  IPAddress remoteIP() override { return _current.from; }
+  uint16_t remotePort() override { return SNTP_PORT; }
+};
+
+bool runScenario(const TScenario &scenario)
+{
+  NtpStandIn standIn(scenario);
+  LocalTime localTime([](uint32_t utc) { return 0; });
+
+  const char *addresses[SNTP_MAX_SERVERS];
+  unsigned long selections[SNTP_MAX_SERVERS] = {0};
+  unsigned long syncs = 0;
+  for (uint8_t i = 0; i < scenario.serverCount; i++)
+    addresses[i] = scenario.servers[i].address;
+
+  SntpClient *client = nullptr;
+  SntpClient sntpClient(
+      standIn, addresses, scenario.serverCount,
+      [&](unsigned long atMillis) { return localTime.getUtcMs(atMillis); },
+      [&](const TSntpSample &sample) {
+        localTime.sync(sample.utc, sample.ms, sample.atMillis);
+        client->setInterval(localTime.getSyncInterval());
+        syncs++;
+        for (uint8_t i = 0; i < scenario.serverCount; i++)
+          if (strcmp(client->getSelectedServer(), addresses[i]) == 0)
+            selections[i]++;
+      });
+  client = &sntpClient;
+
+  nativeSetMillis(0);
+  sntpClient.begin();
+
+  double maxError = 0;
+  double lastError = 0;
+  double maxJump = 0;
+  bool checked = false;
+  unsigned long nextCheck = 0;
+
+  for (unsigned long ms = 0; ms < SIM_DAYS * 86400UL * 1000UL;)
+  {
+    nativeSetMillis(ms);
+    sntpClient.update();
+
+    if (localTime.isSynced() && ((long)(ms - nextCheck) >= 0))
+    {
+      double error = localTime.getUtcMs(ms) - standIn.getTrueMs(ms);
+      if (checked)
+        maxJump = max(maxJump, fabs(error - lastError));
+      if (ms >= SETTLE_MS)
+        maxError = max(maxError, fabs(error));
+      lastError = error;
+      checked = true;
+      nextCheck = ms + CHECK_MS;
+    }
+
+    ms += (sntpClient.getState() == SNTP_IDLE) ? STEP_IDLE_MS : 1;
+  }
+
+  bool passed = (maxError <= scenario.maxErrorMs) && (maxJump <= CLOCK_FILTER_SPIKE_MS);
+
+  printf("%s: drift %.0f ppm, %lu requests, %lu syncs, last interval %lus\r\n",
+         scenario.name, scenario.driftPpm, standIn.requests, syncs, localTime.getSyncInterval() / 1000);
+  for (uint8_t i = 0; i < scenario.serverCount; i++)
+  {
+    const TSntpServer &server = sntpClient.getServer(i);
+    const TSntpSample *best = server.filter.getBest(millis());
+    printf("  %-12s offset %5d ms, delay %3u ms: ", addresses[i], (int)scenario.servers[i].offsetMs, scenario.servers[i].delayMs);
+    if (best)
+      printf("best rtt %3u ms, measured offset %5d ms, selected %lu times\r\n",
+             best->rttMs, (int)ClockFilter::getOffset(*best, [&](unsigned long atMillis) { return (int64_t)standIn.getTrueMs(atMillis); }),
+             selections[i]);
+    else
+      printf("no samples\r\n");
+  }
+  printf("  max error after the first day %.1f ms (limit %u ms), largest step %.1f ms: %s\r\n\r\n",
+         maxError, scenario.maxErrorMs, maxJump, passed ? "ok" : "FAILED");
+  return passed;
+}
+
+int main(int argc, char *argv[])
+{
+  int failures = 0;
+  for (const TScenario &scenario : SCENARIOS)
+    if (!runScenario(scenario))
+      failures++;
+
+  printf("%d of %zu scenarios failed\r\n", failures, sizeof(SCENARIOS) / sizeof(SCENARIOS[0]));
+  return failures == 0 ? 0 : 1;
+}